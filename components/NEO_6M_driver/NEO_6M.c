@@ -4,10 +4,10 @@
  * @brief NEO-6M GPS driver for ESP12/ESP8266.
  *
  * This module provides functionality to interact with the NEO-6M GPS module:
- * - Parse NMEA sentences (GPRMC) to extract latitude and longitude.
- * - Prepare SMS message with current coordinates for SIM800L transmission.
- * - Monitor GPS fix and trigger deep sleep if no fix is obtained within timeout.
- * - Start SIM800L task automatically once a valid fix is acquired.
+ * - Parse NMEA sentences (GPRMC) to extract position, motion and UTC time.
+ * - Publish each valid fix through the shared fix record.
+ * - Read the receiver only while the wake-cycle orchestrator runs the GPS
+ *   phase, and report the fix back to it.
  *
  * @version 0.1
  * @date 2025-09-09
@@ -18,46 +18,33 @@
 #include "freertos/task.h"
 #include "driver/uart.h"
 #include "driver/gpio.h"
-#include "esp_sleep.h"
+#include "../geo/geo.h"
+#include "../rtc_clock/rtc_clock.h"
+#include "../fix_record/fix_record.h"
+#include "../wake_cycle/wake_cycle.h"
+#include "../power/power.h"
 
-// Global variables to store coordinates
-volatile double g_latitude = 0.0;
-volatile double g_longitude = 0.0;
-volatile int g_new_fix = 0;  // flag set to 1 when new fix is available
-
-// Buffer for SMS message
-char smsMessage[64] = { 0 };
-
-// Handle for GPS task
-TaskHandle_t gps_task_handle = NULL;
+/** @brief Link to the receiver, bound by gps_set_transport() */
+static transport_t *s_link;
 
 /**
- * @brief Convert NMEA coordinate format (DDMM.MMMM) to decimal degrees.
+ * @brief Binds the driver to the transport the receiver is wired to.
  *
- * @param nmea_coord The NMEA coordinate string (latitude or longitude).
- * @param hemi Hemisphere character ('N', 'S', 'E', 'W').
- * @return double Decimal degrees, negative for 'S' or 'W'.
+ * Must be called before the wake-cycle orchestrator starts the GPS phase.
  */
-
-static double convert_to_decimal(const char *nmea_coord, const char hemi) {
-	if (strlen(nmea_coord) < 4)
-		return 0.0;
-	double val = atof(nmea_coord);
-	int deg = (int) (val / 100);
-	double min = val - (deg * 100);
-	double decimal = deg + min / 60.0;
-	if (hemi == 'S' || hemi == 'W')
-		decimal *= -1;
-	return decimal;
+void gps_set_transport(transport_t *link) {
+	s_link = link;
 }
 
 /**
  * @brief Parse a GPRMC NMEA sentence to extract valid GPS coordinates.
  *
- * This function reads a GPRMC line, extracts latitude and longitude,
- * converts them to decimal degrees, updates global variables, and
- * prepares the SMS message. If a valid fix is found, it starts the
- * SIM800 task and deletes the GPS task.
+ * This function reads a GPRMC line, extracts latitude, longitude, speed over
+ * ground and course (fields 8 and 9, parsed to fixed point), the UTC time
+ * and date (fields 2 and 10) and the mode indicator (field 13), publishes
+ * them as the shared fix record (`fix_record_publish()`) and syncs the RTC
+ * clock. Deciding what to do with the fix is left to the wake-cycle
+ * orchestrator.
  *
  * @param line The NMEA GPRMC sentence string to parse.
  */
@@ -74,17 +61,23 @@ static void parse_GPRMC(char *line) {
 	char *rest = line;
 
 	char lat[16] = { 0 }, lon[16] = { 0 };
+	char speed[12] = { 0 }, course[12] = { 0 };
+	char utc_time[12] = { 0 }, utc_date[8] = { 0 };
 	char lat_hemi = 'N', lon_hemi = 'E';
-	char status = 'V';
+	char status = 'V', mode = 0;
 
-	token = strtok_r(rest, ",", &rest);
+	// strsep keeps empty fields (e.g. no course while stationary) in place
+	token = strsep(&rest, ",");
 	if (!token || strcmp(token, "$GPRMC") != 0)
 		return;
 
 	int field = 1;
-	while ((token = strtok_r(rest, ",", &rest))) {
+	while ((token = strsep(&rest, ","))) {
 		field++;
 		switch (field) {
+		case 2:
+			strncpy(utc_time, token, sizeof(utc_time) - 1);
+			break;
 		case 3:
 			status = token[0];
 			break;
@@ -100,92 +93,143 @@ static void parse_GPRMC(char *line) {
 		case 7:
 			lon_hemi = token[0];
 			break;
+		case 8:
+			strncpy(speed, token, sizeof(speed) - 1);
+			break;
+		case 9:
+			strncpy(course, token, sizeof(course) - 1);
+			break;
+		case 10:
+			strncpy(utc_date, token, sizeof(utc_date) - 1);
+			break;
+		case 13:
+			mode = token[0];
+			break;
 		}
 	}
 
 	if (status == 'A') {
-		g_latitude = convert_to_decimal(lat, lat_hemi);
-		g_longitude = convert_to_decimal(lon, lon_hemi);
-		g_new_fix = 1;
-
-		snprintf(smsMessage, sizeof(smsMessage), "%.8f, %.8f", g_latitude,
-				g_longitude);
-
-		printf("GPRMC valid: lat=%.6f, lon=%.6f\n", g_latitude, g_longitude);
-		printf("SMS Message prepared: %s\n", smsMessage);
-
-		// Start SIM800 task and delete GPS task
-		static bool sim_task_started = false;
-		if (!sim_task_started) {
-			sim_task_started = true;
-			xTaskCreate(sim800_task, "SIM800", 4096, NULL, 5, NULL);
-			gpio_set_level(GPS_gpio, 0);
-			if (gps_task_handle != NULL) {
-				vTaskDelete(gps_task_handle);
-				gps_task_handle = NULL;
-			}
+		fix_record_t fix = { 0 };
+
+		fix.lat_e7 = geo_nmea_to_e7(lat, lat_hemi);
+		fix.lon_e7 = geo_nmea_to_e7(lon, lon_hemi);
+
+		int32_t speed_cknots = geo_parse_decimal(speed, 2);
+		fix.speed_cms = speed_cknots < 0 ? -1 :
+				(int32_t) ((int64_t) speed_cknots * GEO_CMS_PER_CKNOT_E4 / 10000);
+		fix.course_cdeg = geo_parse_decimal(course, 2);
+		fix.utc_ms = rtc_clock_from_nmea(utc_time, utc_date);
+		fix.uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+		fix.status = status;
+		fix.mode = mode;
+		fix_record_publish(&fix);
+
+		// GPS time stamps the fix and disciplines the deep-sleep clock
+		rtc_clock_sync(fix.utc_ms);
+
+		printf("GPRMC valid: lat=%.6f, lon=%.6f\n",
+				(double) fix.lat_e7 / GEO_E7, (double) fix.lon_e7 / GEO_E7);
+	}
+}
+
+/**
+ * @brief Turns off every default NMEA sentence except RMC.
+ *
+ * Sends one UBX-CFG-MSG (class 0x06, id 0x01) per sentence with a rate of
+ * 0. The default set (GGA, GLL, GSA, GSV, VTG, RMC) is ~500 bytes per
+ * second at 9600 baud, which keeps the line busy half of the time; RMC
+ * alone is ~70 bytes, so `gps_task` can nap most of every second. The
+ * setting is volatile and is sent again at each GPS phase.
+ */
+static void gps_nmea_rmc_only(void) {
+	static const uint8_t sentences[] = { GPS_NMEA_GGA, GPS_NMEA_GLL,
+			GPS_NMEA_GSA, GPS_NMEA_GSV, GPS_NMEA_VTG };
+	uint8_t msg[11] = { 0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0xF0, 0, 0 };
+
+	for (size_t i = 0; i < sizeof(sentences); i++) {
+		msg[7] = sentences[i];
+		msg[8] = 0; // rate: never
+
+		// Fletcher-8 checksum over class, id, length and payload
+		uint8_t ck_a = 0, ck_b = 0;
+		for (int j = 2; j < 9; j++) {
+			ck_a += msg[j];
+			ck_b += ck_a;
 		}
+		msg[9] = ck_a;
+		msg[10] = ck_b;
+		transport_write(s_link, msg, sizeof(msg));
 	}
 }
 
 /**
  * @brief GPS task to read NMEA sentences from the GPS module and extract coordinates.
  *
- * This FreeRTOS task continuously reads data from the GPS UART, buffers complete lines,
- * and checks for valid $GPRMC sentences. If a valid fix is obtained, it updates global
- * latitude and longitude, prepares the SMS message, and starts the SIM800 task.
- * If no fix is found within GPS_TIMEOUT_SEC, the ESP8266 enters deep sleep for GPS_RETRY_SLEEP_SEC.
+ * This FreeRTOS task is created once by the wake-cycle orchestrator and
+ * sleeps until `WAKE_EVT_GPS_RUN` is set. It then reads data from the GPS
+ * transport span by span, buffers complete lines and parses $GPRMC sentences until a valid fix
+ * has been published, which it reports with `WAKE_EVT_FIX`. Once the
+ * receiver talks it is limited to RMC output, and the task naps in light
+ * sleep between the NMEA bursts (`power_rx_nap_idle()`). Reading stops
+ * as soon as the orchestrator clears `WAKE_EVT_GPS_RUN` (GPS phase deadline),
+ * so the shared UART is free for the SIM800.
  *
  * @param arg Task argument (unused).
  */
 
 void gps_task(void *arg) {
-	gps_task_handle = xTaskGetCurrentTaskHandle();
 	static char line_buf[BUF_SIZE];
-	static int line_pos = 0;
-	uint8_t data[128];
-
-	uint32_t start_time = xTaskGetTickCount(); // milliseconds
-
-	gpio_set_level(GPS_gpio, 1);
+	const uint8_t *data;
+	power_rx_nap_t nap;
 
 	while (1) {
-		int len = uart_read_bytes(UART_GPS_RX, data, sizeof(data),
-				100 / portTICK_PERIOD_MS);
-		for (int i = 0; i < len; i++) {
-			char c = data[i];
+		wake_cycle_wait(WAKE_EVT_GPS_RUN, false);
+
+		uint32_t generation = fix_record_generation();
+		int line_pos = 0;
+		bool configured = false;
+		power_rx_nap_init(&nap, s_link, GPS_RX_PIN, GPS_BAUD,
+				GPS_NMEA_PERIOD_MS);
+
+		while (wake_cycle_is_set(WAKE_EVT_GPS_RUN)
+				&& fix_record_generation() == generation) {
+			size_t len = transport_read_span(s_link, &data, POWER_RX_IDLE_MS);
+			if (len > 0) {
+				power_rx_nap_data(&nap, len);
+				if (!configured) {
+					gps_nmea_rmc_only(); // receiver is up, it accepts UBX now
+					configured = true;
+				}
+			} else if (power_rx_nap_idle(&nap)) {
+				continue; // burst due, read again straight away
+			}
+
+			for (size_t i = 0; i < len; i++) {
+				char c = data[i];
 
-			if (c == '\n') {
-				if (line_pos > 0) {
-					line_buf[line_pos] = '\0';
+				if (c == '\n') {
+					if (line_pos > 0) {
+						line_buf[line_pos] = '\0';
 
-					printf("GPS line: %s\n", line_buf);
+						printf("GPS line: %s\n", line_buf);
 
-					if (strstr(line_buf, "$GPRMC")) {
-						parse_GPRMC(line_buf);
+						if (strstr(line_buf, "$GPRMC")) {
+							parse_GPRMC(line_buf);
+						}
+						line_pos = 0;
 					}
-					line_pos = 0;
+				} else if (c != '\r' && line_pos < BUF_SIZE - 1) {
+					line_buf[line_pos++] = c;
 				}
-			} else if (c != '\r' && line_pos < BUF_SIZE - 1) {
-				line_buf[line_pos++] = c;
 			}
-		}
+			transport_consume(s_link, len);
 
-		if (g_new_fix) {
-			start_time = xTaskGetTickCount();
+			vTaskDelay(10 / portTICK_PERIOD_MS);
 		}
 
-		uint32_t elapsed_sec = (xTaskGetTickCount() - start_time)
-				/ configTICK_RATE_HZ;
-		if (!g_new_fix && elapsed_sec >= GPS_TIMEOUT_SEC) {
-			printf("No GPS fix after %d sec, deep sleeping for %d sec...\n",
-			GPS_TIMEOUT_SEC, GPS_RETRY_SLEEP_SEC);
-			gpio_set_level(GPS_gpio, 0);
-
-			// ESP8266 deep sleep
-			esp_deep_sleep(GPS_RETRY_SLEEP_SEC * 1000000ULL);
+		if (fix_record_generation() != generation) {
+			wake_cycle_clear(WAKE_EVT_GPS_RUN);
+			wake_cycle_signal(WAKE_EVT_FIX);
 		}
-
-		vTaskDelay(10 / portTICK_PERIOD_MS);
 	}
 }
@@ -4,10 +4,10 @@
  * @brief NEO-6M GPS driver for ESP12/ESP8266.
  *
  * This module provides functionality to interact with the NEO-6M GPS module:
- * - Parse NMEA sentences (GPRMC) to extract latitude and longitude.
- * - Prepare SMS messages with current coordinates for SIM800L transmission.
- * - Monitor GPS fix and trigger deep sleep if no fix is obtained within timeout.
- * - Start the SIM800L task automatically once a valid fix is acquired.
+ * - Parse NMEA sentences (GPRMC) to extract position, motion and UTC time.
+ * - Publish each valid fix through the shared fix record.
+ * - Read the receiver only while the wake-cycle orchestrator runs the GPS
+ *   phase, and report the fix back to it.
  *
  * @version 0.1
  * @date 2025-09-09
@@ -24,11 +24,23 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "../sim800L_driver/sim800L_driver.h"
-/** @brief UART port for GPS RX */
-#define UART_GPS_RX   UART_NUM_0
+#include "../transport/transport.h"
 
-/** @brief UART port for GPS TX */
-#define UART_GPS_TX   UART_NUM_0
+/** @brief RX pin of the GPS link, wakes the chip from light sleep between NMEA bursts */
+#define GPS_RX_PIN    GPIO_NUM_3
+
+/** @brief GPS line speed (its transport is set up for it in init_esp()) */
+#define GPS_BAUD      9600
+
+/** @brief The receiver sends one NMEA burst per navigation update */
+#define GPS_NMEA_PERIOD_MS 1000
+
+/** @brief UBX ids (class 0xF0) of the standard NMEA sentences disabled at start-up */
+#define GPS_NMEA_GGA  0x00
+#define GPS_NMEA_GLL  0x01
+#define GPS_NMEA_GSA  0x02
+#define GPS_NMEA_GSV  0x03
+#define GPS_NMEA_VTG  0x05
 
 /** @brief Size of the buffer for reading GPS data */
 #define BUF_SIZE      1024
@@ -36,16 +48,10 @@
 /** @brief GPIO used for GPS status indication (e.g., LED blink) */
 #define GPS_gpio 4
 
-/** @brief Maximum time to wait for a GPS fix before entering deep sleep (seconds) */
+/** @brief Maximum time to wait for a GPS fix before the cell-location fallback (seconds) */
 #define GPS_TIMEOUT_SEC 1000
 
-/** @brief Duration to sleep between GPS retry attempts (seconds) */
-#define GPS_RETRY_SLEEP_SEC 300
-
-extern volatile double g_latitude;
-extern volatile double g_longitude;
-extern volatile int g_new_fix;
-
+void gps_set_transport(transport_t *link);
 void gps_task(void *arg);
 
 #endif
@@ -11,10 +11,11 @@
 */
 
 #include "UART.h"
+#if TEST_ON_PC == 0
+#include "../task_registry/task_registry.h"
+#include "../power/power.h"
+#endif
 
-volatile bool start_bit_detected = 0; // Flag for interrupt
-// Define UART structure
-bool stop_bit = 0;
 uint8_t TX_PIN = 2;
 
 /**
@@ -45,7 +46,7 @@ uint8_t TX_PIN = 2;
  * version if 0 is passed for rx_buffer_size and queue_size). No event queue is
  * used (`0, NULL, 0`). Error checking is performed.
  */
-
+#if TEST_ON_PC == 0
 esp_err_t my_uart_init(uart_t *uart) {
 	uart_config_t uart_config =
 			{
@@ -60,210 +61,853 @@ esp_err_t my_uart_init(uart_t *uart) {
 	if (err != ESP_OK)
 		return err; // Return the error if configuration fails
 
-	// Install UART driver
-	err = uart_driver_install(uart->uart_nr, 1024, 0, 0, NULL, 0);
+	// Install UART driver, with the smallest ring the driver accepts if RX is unused
+	err = uart_driver_install(uart->uart_nr,
+			uart->rx_enabled ? UART_RX_RING_SIZE : UART_RX_RING_MIN, 0, 0, NULL,
+			0);
 	if (err != ESP_OK)
 		return err; // Return the error if driver installation fails
 
 	return ESP_OK; // Return success if both operations succeed
 }
+#endif
+
+/** @brief Owner of FRC1, the soft UART is half duplex */
+typedef enum {
+	SOFT_UART_TIMER_IDLE = 0, SOFT_UART_TIMER_RX, SOFT_UART_TIMER_TX
+} soft_uart_timer_owner_t;
+
+/** @brief Supported rates, bit periods computed at compile time */
+static const soft_uart_timing_t s_timings[] = {
+	SOFT_UART_TIMING(9600),
+	SOFT_UART_TIMING(19200),
+	SOFT_UART_TIMING(38400),
+	SOFT_UART_TIMING(57600),
+	SOFT_UART_TIMING(115200),
+};
+
+static volatile soft_uart_timer_owner_t s_timer_owner = SOFT_UART_TIMER_IDLE;
+static bool s_timer_ready = false;
+
+static const soft_uart_timing_t *volatile s_rx_timing = &s_timings[0];
+static soft_uart_rx_t s_rx;
+static volatile uint32_t s_rx_frame_errors = 0;
+static volatile uint32_t s_rx_glitches = 0;
+static ring_buffer_t s_rx_ring;
+static uint8_t s_rx_ring_storage[SOFT_UART_RX_RING_SIZE];
+static volatile TaskHandle_t s_rx_waiter = NULL;
+static bool s_rx_ready = false;
+
+static const soft_uart_timing_t *volatile s_tx_timing = &s_timings[0];
+static uint16_t s_tx_frame;            ///< Start bit, 8 data bits, stop bit
+static uint8_t s_tx_bit;               ///< Next bit of `s_tx_frame` to drive
+static uint32_t s_tx_start;            ///< CCOUNT at the start edge, frame mode
+static ring_buffer_t s_tx_ring;
+static uint8_t s_tx_ring_storage[SOFT_UART_TX_RING_SIZE];
+static volatile TaskHandle_t s_tx_waiter = NULL;
+static bool s_tx_ready = false;
+
+/** @brief Edge-gap measurement of `soft_uart_autobaud()` */
+static volatile struct {
+	bool active;
+	uint32_t edges;     ///< Edges seen in the window
+	uint32_t last;      ///< CCOUNT of the previous edge
+	uint32_t min_gap;   ///< Shorter gaps are glitches (CPU cycles)
+	uint32_t count;     ///< Gaps stored in `gaps`
+	uint32_t gaps[SOFT_UART_AUTOBAUD_GAPS]; ///< Gaps between edges (CPU cycles)
+} s_autobaud;
+
+/**
+ * @brief Reads the CPU cycle counter (the simulated one on the host).
+ */
+static inline uint32_t soft_uart_ccount(void) {
+#if TEST_ON_PC == 0
+	uint32_t ccount;
+	__asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+	return ccount;
+#else
+	return sim_ccount();
+#endif
+}
+
+/**
+ * @brief Spins until CCOUNT reaches `deadline`, wrap-around safe.
+ */
+static inline void soft_uart_spin_until(uint32_t deadline) {
+	while ((int32_t) (soft_uart_ccount() - deadline) < 0)
+		;
+}
+
+/**
+ * @brief Bit period in CPU cycles (Q8) at the current CPU clock.
+ *
+ * The table is in 80 MHz cycles; CCOUNT runs twice as fast at 160 MHz.
+ */
+static inline uint32_t soft_uart_cpu_bit_q8(const soft_uart_timing_t *t) {
+	return t->bit_q8 * (power_cpu_mhz() / 80);
+}
+
+/**
+ * @brief CCOUNT `bits` bit periods after `start`.
+ *
+ * Each deadline is computed from the start edge with the fractional
+ * period, so rounding never accumulates across the frame.
+ *
+ * @param start  CCOUNT at the start edge.
+ * @param bit_q8 Bit period from `soft_uart_cpu_bit_q8()`.
+ * @param halves Offset in half bit periods.
+ */
+static inline uint32_t soft_uart_deadline(uint32_t start, uint32_t bit_q8,
+		uint32_t halves) {
+	return start + ((bit_q8 * halves) >> 9);
+}
+
+/**
+ * @brief Looks up the timing of a supported rate.
+ *
+ * @return The table entry, or NULL if `baud` is not supported.
+ */
+const soft_uart_timing_t* soft_uart_timing(uint32_t baud) {
+	for (size_t i = 0; i < sizeof(s_timings) / sizeof(s_timings[0]); i++)
+		if (s_timings[i].baud == baud)
+			return &s_timings[i];
+	return NULL;
+}
+
+/**
+ * @brief Advances the receiver by one bit, decided by majority vote.
+ *
+ * Called once per bit with the three samples taken around the bit centre,
+ * starting with the start bit. A 2:1 vote still decides the bit but is
+ * counted as noise.
+ *
+ * @param rx    Receiver state, `bit` and `shift` reset on each start edge.
+ * @param votes Number of the three samples that read high (0..3).
+ * @return The received byte (0..255) after the stop bit,
+ *         `SOFT_UART_RX_BUSY` while bits are missing,
+ *         `SOFT_UART_RX_GLITCH` if the start bit was high at its centre, or
+ *         `SOFT_UART_RX_FRAME` if the stop bit was low.
+ */
+IRAM_ATTR int soft_uart_rx_sample(soft_uart_rx_t *rx, int votes) {
+	int level = votes >= 2;
+	if (votes == 1 || votes == 2)
+		rx->noise++;
+
+	if (rx->bit == 0) {
+		rx->bit++;
+		return level ? SOFT_UART_RX_GLITCH : SOFT_UART_RX_BUSY;
+	}
+	if (rx->bit < 9) {
+		rx->shift = (rx->shift >> 1) | (level ? 0x80 : 0);
+		rx->bit++;
+		return SOFT_UART_RX_BUSY;
+	}
+	return level ? rx->shift : SOFT_UART_RX_FRAME;
+}
+
+/**
+ * @brief Takes three samples of the RX line, `spacing` cycles apart from
+ * CCOUNT `first`.
+ *
+ * @return Number of samples that read high.
+ */
+static inline int soft_uart_rx_votes(uint32_t first, uint32_t spacing) {
+	int votes;
+
+	soft_uart_spin_until(first);
+	votes = gpio_get_level(RX_PIN);
+	soft_uart_spin_until(first + spacing);
+	votes += gpio_get_level(RX_PIN);
+	soft_uart_spin_until(first + 2 * spacing);
+	return votes + gpio_get_level(RX_PIN);
+}
+
+/**
+ * @brief Takes the next byte off the TX ring and drives its start bit.
+ *
+ * @return false if the ring is empty.
+ */
+static IRAM_ATTR bool soft_uart_tx_load(void) {
+	uint8_t byte;
+	if (ring_buffer_pop(&s_tx_ring, &byte, 1) == 0)
+		return false;
+
+	s_tx_frame = ((uint16_t) byte << 1) | 0x200; // start bit low, stop bit high
+	s_tx_bit = 1;
+	s_tx_start = soft_uart_ccount();
+	gpio_set_level(TX_PIN, 0);
+	return true;
+}
+
+/**
+ * @brief Hands FRC1 over once a frame is complete.
+ *
+ * Queued TX bytes go first, with the start-bit interrupt kept off until
+ * the ring is empty; otherwise the timer stops and the receiver is
+ * re-armed. Called from an interrupt or inside a critical section.
+ */
+static IRAM_ATTR void soft_uart_timer_next(void) {
+	const soft_uart_timing_t *t = s_tx_timing;
+
+	if (s_tx_ready && ring_buffer_count(&s_tx_ring) > 0) {
+		s_timer_owner = SOFT_UART_TIMER_TX;
+		if (t->frame_mode) {
+			// First interrupt sends a byte at once, as after a stop bit
+			s_tx_bit = 10;
+			s_tx_start = soft_uart_ccount()
+					- (soft_uart_cpu_bit_q8(t) * 10 >> 8);
+			hw_timer_set_load_data(SOFT_UART_SPIN_MARGIN_TICKS);
+		} else {
+			soft_uart_tx_load();
+			hw_timer_set_load_data(t->bit_q8 >> 8);
+		}
+		hw_timer_enable(true);
+		return;
+	}
+
+	hw_timer_enable(false);
+	s_timer_owner = SOFT_UART_TIMER_IDLE;
+	if (s_rx_ready)
+		gpio_set_intr_type(RX_PIN,
+				s_autobaud.active ? GPIO_INTR_ANYEDGE : GPIO_INTR_NEGEDGE);
+}
+
+/**
+ * @brief Ends a TX frame: next byte, or release the timer and notify the
+ * task waiting in `soft_uart_tx_wait()`, if any.
+ */
+static IRAM_ATTR void soft_uart_tx_next(void) {
+	soft_uart_timer_next();
+	if (s_timer_owner == SOFT_UART_TIMER_TX || s_tx_waiter == NULL)
+		return;
+
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	vTaskNotifyGiveFromISR(s_tx_waiter, &xHigherPriorityTaskWoken);
+	s_tx_waiter = NULL;
+	if (xHigherPriorityTaskWoken)
+		portYIELD_FROM_ISR();
+}
+
+/**
+ * @brief FRC1 interrupt, TX side in bit mode: drives the next bit of the
+ * byte on the wire.
+ *
+ * Runs once per bit period on the auto-reloaded timer. After the stop bit
+ * the next queued byte starts right away.
+ */
+static IRAM_ATTR void soft_uart_tx_bit(void) {
+	if (s_tx_bit < 10) {
+		gpio_set_level(TX_PIN, (s_tx_frame >> s_tx_bit) & 1);
+		s_tx_bit++;
+		return;
+	}
+	soft_uart_tx_next();
+}
+
+/**
+ * @brief FRC1 interrupt, TX side in frame mode: sends a whole byte.
+ *
+ * The interrupt comes during the stop bit of the previous frame, waits for
+ * its end, then drives every bit of the next byte on CCOUNT deadlines from
+ * its start edge and returns with the stop bit on the line. The timer is
+ * set to come back `SOFT_UART_SPIN_MARGIN_TICKS` before that stop bit ends.
+ */
+static IRAM_ATTR void soft_uart_tx_frame(void) {
+	uint32_t bit_q8 = soft_uart_cpu_bit_q8(s_tx_timing);
+
+	soft_uart_spin_until(soft_uart_deadline(s_tx_start, bit_q8, 20));
+	if (!s_tx_ready || ring_buffer_count(&s_tx_ring) == 0) {
+		soft_uart_tx_next();
+		return;
+	}
+
+	soft_uart_tx_load();
+	for (; s_tx_bit < 10; s_tx_bit++) {
+		soft_uart_spin_until(
+				soft_uart_deadline(s_tx_start, bit_q8, 2 * s_tx_bit));
+		gpio_set_level(TX_PIN, (s_tx_frame >> s_tx_bit) & 1);
+	}
+	hw_timer_set_load_data(
+			(s_tx_timing->bit_q8 >> 8) - SOFT_UART_SPIN_MARGIN_TICKS);
+}
+
+/**
+ * @brief Stores a received frame and hands FRC1 over.
+ *
+ * A bad frame is dropped alone: the start-bit interrupt is re-armed, so
+ * the receiver resynchronises on the next falling edge while the bytes
+ * already in the ring stay there. The task waiting in `soft_uart_rx_wait()`
+ * is notified at the end of a line or when the ring is half full.
+ */
+static IRAM_ATTR void soft_uart_rx_done(int result) {
+	soft_uart_timer_next();
+
+	if (result == SOFT_UART_RX_FRAME) {
+		s_rx_frame_errors++;
+		return;
+	}
+	if (result == SOFT_UART_RX_GLITCH) {
+		s_rx_glitches++;
+		return;
+	}
+
+	ring_buffer_push(&s_rx_ring, result);
+	if (s_rx_waiter == NULL || (result != '\n'
+			&& ring_buffer_count(&s_rx_ring) < SOFT_UART_RX_RING_SIZE / 2))
+		return;
+
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	vTaskNotifyGiveFromISR(s_rx_waiter, &xHigherPriorityTaskWoken);
+	s_rx_waiter = NULL;
+	if (xHigherPriorityTaskWoken)
+		portYIELD_FROM_ISR();
+}
+
+/**
+ * @brief FRC1 interrupt, RX side in bit mode: samples one bit of the frame
+ * in progress.
+ *
+ * The first interrupt comes `SOFT_UART_VOTE_SPACING_TICKS` before the
+ * centre of the start bit and switches the timer to one bit period,
+ * auto-reloaded; each interrupt votes on three samples spread over the
+ * bit centre. Dropping the fraction of a tick costs at most 0.16 % across
+ * a frame at these rates.
+ */
+static IRAM_ATTR void soft_uart_rx_bit(void) {
+	uint32_t now = soft_uart_ccount();
+	if (s_rx.bit == 0)
+		hw_timer_set_load_data(s_rx_timing->bit_q8 >> 8);
+
+	int result = soft_uart_rx_sample(&s_rx, soft_uart_rx_votes(now,
+			SOFT_UART_VOTE_SPACING_TICKS * (power_cpu_mhz() / 80)));
+	if (result != SOFT_UART_RX_BUSY)
+		soft_uart_rx_done(result);
+}
+
+/**
+ * @brief FRC1 interrupt: one bit period of the direction owning the timer.
+ */
+static IRAM_ATTR void soft_uart_timer_isr(void *arg) {
+	if (s_timer_owner != SOFT_UART_TIMER_TX)
+		soft_uart_rx_bit();
+	else if (s_tx_timing->frame_mode)
+		soft_uart_tx_frame();
+	else
+		soft_uart_tx_bit();
+}
 
-// ISR to detect the start of the UART reception (start bit)
+/**
+ * @brief Start-bit interrupt.
+ *
+ * In bit mode it arms FRC1 for the first vote on the start bit. In frame
+ * mode it samples the whole frame itself, on CCOUNT deadlines counted from
+ * the start edge, since the interrupt entry cost is close to a bit period.
+ * The edge interrupt stays off until the frame is complete, so data bits
+ * never re-trigger it.
+ */
 IRAM_ATTR void uart_rx_isr_handler(void *arg) {
-	start_bit_detected = 1;
+	uint32_t edge = soft_uart_ccount()
+			- SOFT_UART_EDGE_LATENCY_TICKS * (power_cpu_mhz() / 80);
+	const soft_uart_timing_t *t = s_rx_timing;
+
+	if (s_autobaud.active) {
+		// Both edges interrupt: every gap is a run of equal bits
+		uint32_t gap = edge - s_autobaud.last;
+		if (s_autobaud.edges > 0 && gap >= s_autobaud.min_gap
+				&& s_autobaud.count < SOFT_UART_AUTOBAUD_GAPS)
+			s_autobaud.gaps[s_autobaud.count++] = gap;
+		s_autobaud.last = edge;
+		s_autobaud.edges++;
+		return;
+	}
+
+	gpio_set_intr_type(RX_PIN, GPIO_INTR_DISABLE);
+	if (s_timer_owner != SOFT_UART_TIMER_IDLE)
+		return; // TX owns the timer, re-armed once it is done
+
+	s_timer_owner = SOFT_UART_TIMER_RX;
+	s_rx.bit = 0;
+	s_rx.shift = 0;
+
+	if (!t->frame_mode) {
+		hw_timer_set_load_data((t->bit_q8 / 2 >> 8)
+				- SOFT_UART_EDGE_LATENCY_TICKS - SOFT_UART_VOTE_SPACING_TICKS);
+		hw_timer_enable(true);
+		return;
+	}
+
+	uint32_t bit_q8 = soft_uart_cpu_bit_q8(t);
+	uint32_t spacing = SOFT_UART_VOTE_SPACING_TICKS * (power_cpu_mhz() / 80);
+	int result = SOFT_UART_RX_BUSY;
+	for (uint32_t halves = 1; result == SOFT_UART_RX_BUSY; halves += 2) {
+		uint32_t centre = soft_uart_deadline(edge, bit_q8, halves);
+		result = soft_uart_rx_sample(&s_rx,
+				soft_uart_rx_votes(centre - spacing, spacing));
+	}
+	soft_uart_rx_done(result);
+}
+
+/**
+ * @brief Copies the soft UART receive counters.
+ */
+void soft_uart_rx_get_stats(soft_uart_rx_stats_t *out) {
+	out->bytes = s_rx_ring.head;
+	out->frame_errors = s_rx_frame_errors;
+	out->noise = s_rx.noise;
+	out->glitches = s_rx_glitches;
+	out->overruns = s_rx_ring.overruns;
+	out->peak = s_rx_ring.peak;
 }
 
 /**
- * @brief FreeRTOS task for bit-banging UART receive.
+ * @brief Changes the soft UART rates.
+ *
+ * Takes effect from the next frame in each direction.
  *
- * This task continuously monitors the `RX_PIN` for a start bit.
- * Upon detection, it samples the incoming data line at precise intervals
- * to reconstruct bytes. It then stores these bytes in a buffer and,
- * when the buffer is full or a stop condition is met, prints the received
- * string. The task manages enabling/disabling the RX interrupt during
- * reception.
+ * @param rx_baud Receive rate, one of the `soft_uart_timing()` rates.
+ * @param tx_baud Transmit rate, one of the `soft_uart_timing()` rates.
+ * @return `ESP_ERR_NOT_SUPPORTED` if a rate is not in the table.
  */
+esp_err_t soft_uart_set_baud(uint32_t rx_baud, uint32_t tx_baud) {
+	const soft_uart_timing_t *rx = soft_uart_timing(rx_baud);
+	const soft_uart_timing_t *tx = soft_uart_timing(tx_baud);
+	if (rx == NULL || tx == NULL) {
+		printf("soft_uart_set_baud: unsupported rate %u / %u\n", rx_baud,
+				tx_baud);
+		return ESP_ERR_NOT_SUPPORTED;
+	}
 
-void uart_bitbang_receive_task(void *param) {
-	uint8_t received_data[BUFFER_SIZE];
-	int index = 0;
+	taskENTER_CRITICAL();
+	s_rx_timing = rx;
+	s_tx_timing = tx;
+	taskEXIT_CRITICAL();
+	return ESP_OK;
+}
+
+/**
+ * @brief Checks the gaps measured by `soft_uart_autobaud()` against one
+ * rate.
+ *
+ * Every gap between two edges of a frame is a run of equal bits, a whole
+ * number of bit periods from 1 to 10; longer gaps are idle line and left
+ * out. The rate fits if at least `SOFT_UART_AUTOBAUD_MATCH_PCT` of the
+ * other gaps are within `SOFT_UART_AUTOBAUD_TOLERANCE_PCT` of a whole
+ * number of its bits, and `SOFT_UART_AUTOBAUD_MIN_SINGLE` of them are one
+ * bit long.
+ *
+ * @param t     Candidate rate.
+ * @param gaps  Gaps in CPU cycles.
+ * @param count Number of gaps.
+ * @return true if the rate fits the gaps.
+ */
+static bool soft_uart_autobaud_fits(const soft_uart_timing_t *t,
+		const volatile uint32_t *gaps, uint32_t count) {
+	uint32_t bit = soft_uart_cpu_bit_q8(t) >> 8;
+	uint32_t match = 0, miss = 0, single = 0;
+
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t bits = (gaps[i] + bit / 2) / bit;
+		if (bits > 10)
+			continue;
+
+		uint32_t whole = bits * bit;
+		uint32_t err = gaps[i] > whole ? gaps[i] - whole : whole - gaps[i];
+		if (bits == 0 || err * 100 > bit * SOFT_UART_AUTOBAUD_TOLERANCE_PCT) {
+			miss++;
+			continue;
+		}
+		match++;
+		if (bits == 1)
+			single++;
+	}
+	return single >= SOFT_UART_AUTOBAUD_MIN_SINGLE
+			&& match * 100 >= (match + miss) * SOFT_UART_AUTOBAUD_MATCH_PCT;
+}
+
+/**
+ * @brief Detects the rate of the peripheral on `RX_PIN` and retunes the
+ * soft UART to it.
+ *
+ * For `window_ms` both edges of the line interrupt and the first
+ * `SOFT_UART_AUTOBAUD_GAPS` gaps between them are measured on CCOUNT.
+ * Gaps shorter than `SOFT_UART_AUTOBAUD_TOLERANCE_PCT` below the fastest
+ * bit are glitches and ignored. The rates of the timing table are then
+ * tried from the slowest, and the first one most gaps fit is used in both
+ * directions (a slower rate never fits, its bit is too long for the
+ * one-bit runs; see `soft_uart_autobaud_fits()`). A stray gap from a glitch
+ * or a slow interrupt is outvoted instead of deciding the rate. Nothing is
+ * received during the window.
+ *
+ * @param window_ms Measurement time; the peripheral must be sending.
+ * @return The detected rate, or 0 if too few edges were seen or no rate
+ *         fits the gaps well enough; the rates are then left alone.
+ */
+uint32_t soft_uart_autobaud(uint32_t window_ms) {
+	if (!s_rx_ready)
+		return 0;
+
+	// Let a frame in progress finish, then take the edge interrupt over
 	while (1) {
+		taskENTER_CRITICAL();
+		if (s_timer_owner != SOFT_UART_TIMER_RX)
+			break;
+		taskEXIT_CRITICAL();
+		vTaskDelay(1);
+	}
+	const size_t rates = sizeof(s_timings) / sizeof(s_timings[0]);
+	s_autobaud.edges = 0;
+	s_autobaud.count = 0;
+	s_autobaud.min_gap = (soft_uart_cpu_bit_q8(&s_timings[rates - 1]) >> 8)
+			* (100 - SOFT_UART_AUTOBAUD_TOLERANCE_PCT) / 100;
+	s_autobaud.active = true;
+	if (s_timer_owner == SOFT_UART_TIMER_IDLE)
+		gpio_set_intr_type(RX_PIN, GPIO_INTR_ANYEDGE);
+	taskEXIT_CRITICAL();
+
+	vTaskDelay(pdMS_TO_TICKS(window_ms));
+
+	taskENTER_CRITICAL();
+	s_autobaud.active = false;
+	if (s_timer_owner == SOFT_UART_TIMER_IDLE)
+		gpio_set_intr_type(RX_PIN, GPIO_INTR_NEGEDGE);
+	taskEXIT_CRITICAL();
+
+	uint32_t edges = s_autobaud.edges;
+	uint32_t count = s_autobaud.count;
+	if (edges < SOFT_UART_AUTOBAUD_MIN_EDGES
+			|| count < SOFT_UART_AUTOBAUD_MIN_EDGES) {
+		printf("soft_uart_autobaud: %u edges in %u ms, line idle?\n", edges,
+				window_ms);
+		return 0;
+	}
+
+	for (size_t i = 0; i < rates; i++) {
+		const soft_uart_timing_t *t = &s_timings[i];
+		if (!soft_uart_autobaud_fits(t, s_autobaud.gaps, count))
+			continue;
+
+		printf("Soft UART: autobaud %u baud (%u gaps, %u edges)\n", t->baud,
+				count, edges);
+		soft_uart_set_baud(t->baud, t->baud);
+		return t->baud;
+	}
+
+	printf("soft_uart_autobaud: %u gaps fit no rate\n", count);
+	return 0;
+}
+
+/**
+ * @brief Waits until received bytes are in the ring.
+ *
+ * The FRC1 interrupt notifies the caller at a line end or a half-full
+ * ring; other bytes are noticed within `SOFT_UART_RX_FLUSH_MS`. Uses the
+ * task notification of the caller.
+ *
+ * @param timeout Longest wait in ticks.
+ * @return true if bytes are waiting.
+ */
+bool soft_uart_rx_wait(TickType_t timeout) {
+	TickType_t start = xTaskGetTickCount();
+
+	while (ring_buffer_count(&s_rx_ring) == 0) {
+		TickType_t waited = xTaskGetTickCount() - start;
+		if (waited >= timeout)
+			return false;
+
+		TickType_t left = timeout - waited;
+		TickType_t flush = pdMS_TO_TICKS(SOFT_UART_RX_FLUSH_MS);
+		s_rx_waiter = xTaskGetCurrentTaskHandle();
+		ulTaskNotifyTake(pdTRUE, left < flush ? left : flush);
+		s_rx_waiter = NULL;
+	}
+	return true;
+}
 
-		if (start_bit_detected) {
-			uint8_t byte = 0;
+/**
+ * @brief Gives the next contiguous run of received bytes, in place.
+ *
+ * @param span Set to the first waiting byte.
+ * @return Length of the span, 0 if nothing was received.
+ */
+size_t soft_uart_read_span(const uint8_t **span) {
+	return ring_buffer_peek(&s_rx_ring, span);
+}
 
-			gpio_isr_handler_remove(RX_PIN); // Disable interrupt while receiving
+/**
+ * @brief Releases `len` bytes read through `soft_uart_read_span()`.
+ */
+void soft_uart_consume(size_t len) {
+	ring_buffer_consume(&s_rx_ring, len);
+}
 
-			ets_delay_us(BIT_TIME_US_RX / 2); // Move to center of first data bit
+/**
+ * @brief FreeRTOS task collecting soft UART bytes into lines.
+ *
+ * Sleeps in `soft_uart_rx_wait()`, then scans the ring in place span by
+ * span. A line that lies whole in a span is printed in place; only lines
+ * split by the wrap-around or by a flush are assembled in `line`, which is
+ * printed when complete or full.
+ */
+void uart_bitbang_receive_task(void *param) {
+	static char line[BUFFER_SIZE];
+	size_t index = 0;
+	const uint8_t *span;
+	size_t len;
 
-			for (int i = 0; i < 8; i++) {
-				ets_delay_us(BIT_TIME_US_RX);          // Wait for each bit
-				byte |= (gpio_get_level(RX_PIN) << i); // Read bit and store in byte
+	while (1) {
+		soft_uart_rx_wait(portMAX_DELAY);
+
+		while ((len = soft_uart_read_span(&span)) > 0) {
+			const uint8_t *nl = memchr(span, '\n', len);
+			size_t take = nl ? (size_t) (nl - span) + 1 : len;
+
+			// Whole line inside the span: print it straight from the ring
+			if (nl && index == 0) {
+				int n = nl - span;
+				if (n > 0 && span[n - 1] == '\r')
+					n--;
+				if (n > 0)
+					printf("Soft UART: %.*s\n", n, (const char *) span);
+				soft_uart_consume(take);
+				continue;
 			}
-			ets_delay_us(BIT_TIME_US_RX); // Wait for each bit
-			stop_bit = gpio_get_level(RX_PIN);
 
-			if (!stop_bit) {
-				ets_delay_us(BIT_TIME_US_RX * 1.1);
-				index = 0;
-			} else {
-				if (index < BUFFER_SIZE) {
-					received_data[index++] = byte;
-				} else {
-					printf("new : %s \n", received_data);
-					index = 0;
-					esp_task_wdt_reset();
+			for (size_t i = 0; i < take; i++) {
+				uint8_t byte = span[i];
+				if (byte != '\n' && byte != '\r') {
+					line[index++] = byte;
+					if (index < BUFFER_SIZE - 1)
+						continue;
+				} else if (byte == '\r' || index == 0) {
+					continue;
 				}
-				stop_bit = 0;
+
+				line[index] = '\0';
+				printf("Soft UART: %s\n", line);
+				index = 0;
 			}
-			start_bit_detected = 0;
-			gpio_isr_handler_add(RX_PIN, uart_rx_isr_handler, NULL);
+			soft_uart_consume(take);
 		}
 	}
 }
 
 /**
- * @brief Initializes GPIO for UART reception and creates the bit-banging
- * receive task.
+ * @brief Sets up FRC1 once for both directions: 80 MHz, auto-reload,
+ * stopped until a start bit arrives or a byte is queued for TX.
+ */
+static esp_err_t soft_uart_timer_init(void) {
+	if (s_timer_ready)
+		return ESP_OK;
+
+	esp_err_t ret = hw_timer_init(soft_uart_timer_isr, NULL);
+	if (ret == ESP_OK)
+		ret = hw_timer_set_clkdiv(TIMER_CLKDIV_1);
+	if (ret == ESP_OK)
+		ret = hw_timer_set_intr_type(TIMER_EDGE_INT);
+	if (ret == ESP_OK)
+		ret = hw_timer_set_reload(true);
+	if (ret != ESP_OK) {
+		printf("soft_uart_timer_init: FRC1 timer setup failed, error: %d\n",
+				ret);
+		return ret;
+	}
+	hw_timer_enable(false);
+	s_timer_ready = true;
+	return ESP_OK;
+}
+
+/**
+ * @brief Initializes GPIO and FRC1 for soft UART reception.
  *
- * This function configures the `RX_PIN` as an input with pull-up and sets up a
- * negative edge interrupt. It then installs the GPIO ISR service and registers
- * `uart_rx_isr_handler` to detect start bits. Finally, it creates and starts
- * the `uart_bitbang_receive_task` to handle the actual data reception.
+ * This function configures the `RX_PIN` as an input with pull-up and a
+ * negative edge interrupt for the start bit, installs the GPIO ISR service
+ * (if not already done) and registers `uart_rx_isr_handler`. FRC1 is set
+ * up undivided (80 MHz) with `soft_uart_timer_isr` sampling the bits.
+ * Received bytes wait in the ring for `soft_uart_read_span()`.
  *
- * @return `ESP_OK` if all configurations and task creation are successful;
- * otherwise, returns an `esp_err_t` error code indicating the failure.
+ * @return `ESP_OK` if all configurations are successful; otherwise,
+ * returns an `esp_err_t` error code indicating the failure.
  */
-
-esp_err_t start_reciving_task(void) {
+esp_err_t soft_uart_rx_init(void) {
 	gpio_config_t io_conf = { .pin_bit_mask = (1ULL << RX_PIN), .mode =
 			GPIO_MODE_INPUT, .pull_up_en = GPIO_PULLUP_ENABLE, .pull_down_en =
 			GPIO_PULLDOWN_DISABLE, .intr_type = GPIO_INTR_NEGEDGE };
 
+	ring_buffer_init(&s_rx_ring, s_rx_ring_storage, SOFT_UART_RX_RING_SIZE);
+	s_rx_timing = soft_uart_timing(BAUD_RATE_RX);
+	if (s_rx_timing == NULL) {
+		printf("soft_uart_rx_init: unsupported rate %u\n", BAUD_RATE_RX);
+		s_rx_timing = &s_timings[0];
+		return ESP_ERR_NOT_SUPPORTED;
+	}
+
+	esp_err_t ret = soft_uart_timer_init();
+	if (ret != ESP_OK)
+		return ret;
+
 	// GPIO configuration
-	esp_err_t ret = gpio_config(&io_conf);
+	ret = gpio_config(&io_conf);
 	if (ret != ESP_OK) {
-		printf("start_reciving_task: GPIO configuration failed, error: %d\n",
+		printf("soft_uart_rx_init: GPIO configuration failed, error: %d\n",
 				ret);
 		return ret; // Return error code if GPIO config fails
 	}
 
-	// Install ISR service
+	// Install ISR service (already done if the OTA button is armed)
 	ret = gpio_install_isr_service(0);
-	if (ret != ESP_OK) {
+	if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
 		printf(
-				"start_reciving_task: ISR service installation failed, error: %d\n",
+				"soft_uart_rx_init: ISR service installation failed, error: %d\n",
 				ret);
 		return ret; // Return error code if ISR service fails
 	}
 
 	// Add ISR handler
+	s_rx_ready = true;
 	ret = gpio_isr_handler_add(RX_PIN, uart_rx_isr_handler, NULL);
 	if (ret != ESP_OK) {
-		printf("start_reciving_task: ISR handler addition failed, error: %d\n",
+		s_rx_ready = false;
+		printf("soft_uart_rx_init: ISR handler addition failed, error: %d\n",
 				ret);
 		return ret; // Return error code if adding ISR handler fails
 	}
 
-	// Create receiving task
-	BaseType_t task_create_status = xTaskCreate(uart_bitbang_receive_task,
-			"uart_rx_task", 4096, NULL,
-			configMAX_PRIORITIES - 1, NULL);
-	if (task_create_status != pdPASS) {
-		printf("start_reciving_task: Task creation failed\n");
-		return ESP_FAIL; // Return failure code if task creation fails
-	}
-
 	return ESP_OK; // Return success if everything succeeded
 }
 
+#if TEST_ON_PC == 0
 /**
- * @brief Sends a single byte over UART using bit-banging.
+ * @brief Initializes soft UART reception and creates the receive task,
+ * which prints every received line.
  *
- * This function manually controls the `TX_PIN` to transmit one byte of data
- * by simulating UART protocol:
- * - Sends a **start bit** (low).
- * - Sends 8 **data bits** (least significant bit first).
- * - Sends a **stop bit** (high).
- * Precise timing for each bit is achieved using `ets_delay_us()`.
- *
- * @param byte The 8-bit data byte to be transmitted.
+ * @return `ESP_OK` on success, otherwise the error of the failing step.
  */
-// Function to send a single byte via bit-banging
-static void uart_bitbang_send_byte(uint8_t byte) {
-	// Start bit (low)
-	gpio_set_level(TX_PIN, 0);
-	ets_delay_us(BIT_TIME_US_TX);
+esp_err_t start_reciving_task(void) {
+	esp_err_t ret = soft_uart_rx_init();
+	if (ret != ESP_OK)
+		return ret;
 
-	// Send 8 data bits (LSB first)
-	for (int i = 0; i < 8; i++) {
-		gpio_set_level(TX_PIN, (byte >> i) & 1);
-		ets_delay_us(BIT_TIME_US_TX);
+	if (task_registry_create(TASK_ID_UART_RX, uart_bitbang_receive_task, NULL)
+			== NULL) {
+		printf("start_reciving_task: Task creation failed\n");
+		return ESP_FAIL; // Return failure code if task creation fails
 	}
-
-	// Stop bit (high)
-	gpio_set_level(TX_PIN, 1);
-	ets_delay_us(BIT_TIME_US_TX);
+	return ESP_OK;
 }
+#endif
 
 /**
- * @brief Sends a string over UART using bit-banging.
+ * @brief Queues bytes for the soft UART transmitter and returns at once.
  *
- * This function iterates through each character of a given string and
- * transmits each character as a single byte using the `uart_bitbang_send_byte`
- * function.
+ * The bytes go out bit by bit from the FRC1 interrupt while the caller
+ * carries on. A transmission queued while a byte is being received starts
+ * after its stop bit.
  *
- * @param str A pointer to the constant character array (string) to be sent.
- * @param length The number of characters (bytes) in the string to transmit.
+ * @param data Bytes to send.
+ * @param len  Number of bytes.
+ * @return Number of bytes queued, less than `len` if the TX ring is full
+ *         and 0 if `init_transmit()` was not called.
  */
-
-// Function to send a string
-void uart_bitbang_send_string(const char *str, size_t length) {
-	for (size_t i = 0; i < length; i++)
-		uart_bitbang_send_byte(str[i]);
+size_t soft_uart_write(const void *data, size_t len) {
+	if (!s_tx_ready)
+		return 0;
+
+	const uint8_t *bytes = data;
+	size_t room = SOFT_UART_TX_RING_SIZE - ring_buffer_count(&s_tx_ring);
+	size_t queued = len < room ? len : room;
+	for (size_t i = 0; i < queued; i++)
+		ring_buffer_push(&s_tx_ring, bytes[i]);
+
+	taskENTER_CRITICAL();
+	if (s_timer_owner == SOFT_UART_TIMER_IDLE) {
+		if (s_rx_ready)
+			gpio_set_intr_type(RX_PIN, GPIO_INTR_DISABLE);
+		soft_uart_timer_next();
+	}
+	taskEXIT_CRITICAL();
+	return queued;
 }
 
 /**
- * @brief FreeRTOS task for continuously sending a UART message (currently
- * commented out).
+ * @brief Blocks the calling task until every queued byte is on the wire.
  *
- * This task is designed to run indefinitely, sending a predefined message via
- * bit-banged UART. However, the message sending logic is currently commented
- * out.
+ * Uses the task notification of the caller, which the FRC1 interrupt gives
+ * when the TX ring runs empty.
  *
- * @param param Unused parameter, required by FreeRTOS task signature.
+ * @param timeout Longest wait in ticks.
+ * @return true if the transmitter is idle.
+ */
+bool soft_uart_tx_wait(TickType_t timeout) {
+	bool idle;
+
+	taskENTER_CRITICAL();
+	idle = s_timer_owner != SOFT_UART_TIMER_TX
+			&& ring_buffer_count(&s_tx_ring) == 0;
+	if (!idle)
+		s_tx_waiter = xTaskGetCurrentTaskHandle();
+	taskEXIT_CRITICAL();
+	if (idle)
+		return true;
+
+	ulTaskNotifyTake(pdTRUE, timeout);
+
+	taskENTER_CRITICAL();
+	s_tx_waiter = NULL;
+	idle = s_timer_owner != SOFT_UART_TIMER_TX
+			&& ring_buffer_count(&s_tx_ring) == 0;
+	taskEXIT_CRITICAL();
+	return idle;
+}
+
+/**
+ * @brief Sends a string over the soft UART.
  *
- * The task's `while(1)` loop would typically:
- * - Call `uart_bitbang_send_string()` to transmit a message.
- * - Introduce a delay using `vTaskDelay()` to control the sending interval.
+ * Returns as soon as the last byte is queued; a string longer than the
+ * free space of the TX ring waits for the ring to drain in between.
  *
- * As of the current code, the task simply enters an infinite loop without
- * performing any actions.
+ * @param str A pointer to the constant character array (string) to be sent.
+ * @param length The number of characters (bytes) in the string to transmit.
  */
+void uart_bitbang_send_string(const char *str, size_t length) {
+	size_t sent = 0;
 
-// Task to continuously send a message
-static void uart_task(void *param) {
-	while (1) {
-		// uart_bitbang_send_string(
-		//		"Hello from bit-banged UART1 on GPIO2 (D4)!\n");
-		// vTaskDelay(pdMS_TO_TICKS(1000));  // Wait 1 second
+	while (sent < length) {
+		size_t queued = soft_uart_write(str + sent, length - sent);
+		if (queued == 0 && !s_tx_ready) {
+			printf("uart_bitbang_send_string: transmitter not initialized\n");
+			return;
+		}
+		sent += queued;
+		if (sent < length)
+			soft_uart_tx_wait(pdMS_TO_TICKS(SOFT_UART_TX_WAIT_MS));
 	}
 }
 
 /**
- * @brief Initializes the GPIO for UART transmission and creates the UART send
- * task.
+ * @brief Initializes the GPIO and FRC1 for soft UART transmission.
+ *
+ * This function sets up the `TX_PIN` as an output in the idle (high) state
+ * and the TX ring drained by the FRC1 interrupt. No task is needed: bytes
+ * queued with `soft_uart_write()` are sent in the background.
  *
- * This function sets up the `TX_PIN` as an output and ensures it's in the idle
- * (high) state. It then creates and starts the `uart_task`, which is
- * responsible for continuously sending data via bit-banged UART.
+ * @return `ESP_OK` on success, or the FRC1 setup error.
  */
-
-static void init_transmit_task() {
+esp_err_t init_transmit(void) {
 	// Configure TX pin as output
 	gpio_set_direction(TX_PIN, GPIO_MODE_OUTPUT);
 	gpio_set_level(TX_PIN, 1); // Idle state is high
 
-	// Start UART task
-	xTaskCreate(uart_task, "uart_task", 2048, NULL, 1, NULL);
+	ring_buffer_init(&s_tx_ring, s_tx_ring_storage, SOFT_UART_TX_RING_SIZE);
+	s_tx_timing = soft_uart_timing(BAUD_RATE_TX);
+	if (s_tx_timing == NULL) {
+		printf("init_transmit: unsupported rate %u\n", BAUD_RATE_TX);
+		s_tx_timing = &s_timings[0];
+		return ESP_ERR_NOT_SUPPORTED;
+	}
+
+	esp_err_t ret = soft_uart_timer_init();
+	if (ret != ESP_OK)
+		return ret;
+	s_tx_ready = true;
+	return ESP_OK;
 }
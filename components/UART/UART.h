@@ -16,6 +16,7 @@
 
 #if TEST_ON_PC == 0
 #include "stdio.h"
+#include "string.h"
 #include "stdbool.h"
 #include "stdarg.h" // Needed for va_list
 #include "freertos/FreeRTOS.h"
@@ -23,8 +24,13 @@
 #include "esp_system.h"
 #include "driver/gpio.h"
 #include "driver/uart.h"
+#include "driver/hw_timer.h"
 #include "esp8266/pin_mux_register.h"
 #include "esp_task_wdt.h"
+#else
+#include "UART_tests.h"
+#endif
+#include "../ring_buffer/ring_buffer.h"
 
 /**
  * @brief Configuration macros for bit-banged UART communication and system parameters.
@@ -37,11 +43,34 @@
 #define SERIAL_MONITOR_BAUD_RATE 115200 ///< Baud rate for the standard serial monitor.
 #define RX_PIN GPIO_NUM_12              ///< GPIO pin designated for bit-banged UART reception.
 #define BAUD_RATE_RX 9600               ///< Baud rate for bit-banged UART reception.
-#define BIT_TIME_US_RX (1000000 / BAUD_RATE_RX) ///< Calculated time (in microseconds) for one bit during reception.
-#define BUFFER_SIZE 128                 ///< Size of the buffer used for received UART data.
+#define BUFFER_SIZE 128                 ///< Size of the line buffer of the soft UART receive task.
+#define UART_RX_RING_SIZE 2048          ///< RX ring of the UART driver (shared by GPS and SIM800 replies).
+#define UART_RX_RING_MIN 256            ///< RX ring of a port without RX (UART1); the driver wants more than its FIFO.
 
 #define BAUD_RATE_TX 9600               ///< Baud rate for bit-banged UART transmission.
-#define BIT_TIME_US_TX (1000000 / BAUD_RATE_TX) + 1 ///< Calculated time (in microseconds) for one bit during transmission, with a small adjustment.
+
+#define SOFT_UART_TIMER_HZ 80000000     ///< FRC1 clock (APB, undivided), and CCOUNT at 80 MHz.
+#define SOFT_UART_BIT_Q8(baud) ((uint32_t) (((uint64_t) SOFT_UART_TIMER_HZ * 256 + (baud) / 2) / (baud))) ///< 80 MHz cycles per bit, Q24.8.
+#ifndef SOFT_UART_FRAME_MODE_BAUD
+#define SOFT_UART_FRAME_MODE_BAUD 115200 ///< From this rate a whole frame is timed on CCOUNT per interrupt.
+#endif
+#define SOFT_UART_TIMING(baud) { (baud), SOFT_UART_BIT_Q8(baud), (baud) >= SOFT_UART_FRAME_MODE_BAUD } ///< soft_uart_timing_t initializer.
+#define SOFT_UART_EDGE_LATENCY_TICKS 160 ///< Start edge to handler entry, through the GPIO ISR service (~2 us).
+#define SOFT_UART_SPIN_MARGIN_TICKS 240  ///< Frame mode TX interrupt comes this early and spins (~3 us).
+#define SOFT_UART_VOTE_SPACING_TICKS 80  ///< Gap between the three samples of a bit (~1 us).
+#define SOFT_UART_AUTOBAUD_MIN_EDGES 32  ///< Fewer edges in the window and autobaud gives up.
+#define SOFT_UART_AUTOBAUD_GAPS 128      ///< Gaps between edges kept for the vote (first ones of the window).
+#define SOFT_UART_AUTOBAUD_TOLERANCE_PCT 12 ///< Largest distance of a gap from a whole number of bits, % of a bit.
+#define SOFT_UART_AUTOBAUD_MATCH_PCT 80  ///< Share of the gaps up to 10 bits that must be whole numbers of bits.
+#define SOFT_UART_AUTOBAUD_MIN_SINGLE 4  ///< One-bit gaps needed, so a multiple of the real bit never wins.
+#define SOFT_UART_RX_RING_SIZE 256      ///< Receive ring between the FRC1 ISR and the task (power of two).
+#define SOFT_UART_RX_FLUSH_MS 50        ///< The task also drains the ring this often without a line end.
+#define SOFT_UART_TX_RING_SIZE 256      ///< Transmit ring drained by the FRC1 ISR (power of two).
+#define SOFT_UART_TX_WAIT_MS 500        ///< Longest wait for TX ring space in uart_bitbang_send_string().
+
+#define SOFT_UART_RX_BUSY  (-1)         ///< soft_uart_rx_sample(): more bits to sample.
+#define SOFT_UART_RX_FRAME (-2)         ///< soft_uart_rx_sample(): stop bit was low, byte dropped.
+#define SOFT_UART_RX_GLITCH (-3)        ///< soft_uart_rx_sample(): start bit was high at its centre.
 
 #define GPIO_INPUT 0                    ///< Alias for GPIO input mode (for clarity).
 #define GPIO_OUTPUT 1                   ///< Alias for GPIO output mode (for clarity).
@@ -62,19 +91,58 @@ typedef struct {
     int baud_rate;    ///< The communication speed in bits per second (baud).
 } uart_t;
 
+/**
+ * @brief Soft UART receiver state, advanced by one vote per bit.
+ */
+typedef struct {
+    uint8_t bit;      ///< Bits decided in the current frame (0 = start bit, 9 = stop bit next).
+    uint8_t shift;    ///< Data bits received so far, LSB first.
+    uint32_t noise;   ///< Bits decided 2:1, running count.
+} soft_uart_rx_t;
+
+/**
+ * @brief Bit timing of one soft UART rate.
+ *
+ * Below `SOFT_UART_FRAME_MODE_BAUD` each bit is an FRC1 interrupt. From
+ * that rate the interrupt entry cost is close to a bit period, so a frame is sent
+ * or sampled in one interrupt, spinning on CCOUNT deadlines counted from
+ * the start edge.
+ */
+typedef struct {
+    uint32_t baud;    ///< Line rate.
+    uint32_t bit_q8;  ///< Bit period in 80 MHz cycles, Q24.8.
+    bool frame_mode;  ///< Whole frame per interrupt, timed on CCOUNT.
+} soft_uart_timing_t;
+
+/**
+ * @brief Soft UART receive counters.
+ */
+typedef struct {
+    uint32_t bytes;        ///< Bytes stored in the receive ring.
+    uint32_t frame_errors; ///< Frames dropped because the stop bit was low.
+    uint32_t noise;        ///< Bits whose three samples disagreed (decided 2:1).
+    uint32_t glitches;     ///< Falling edges dropped because the start bit did not hold.
+    uint32_t overruns;     ///< Bytes dropped because the receive ring was full.
+    uint32_t peak;         ///< Highest fill level of the receive ring.
+} soft_uart_rx_stats_t;
+
 esp_err_t my_uart_init(uart_t *uart);
-uint8_t uart_bitbang_receive_byte();
 void uart_bitbang_receive_task(void *param);
+esp_err_t soft_uart_rx_init(void);
 esp_err_t start_reciving_task(void);
+bool soft_uart_rx_wait(TickType_t timeout);
+size_t soft_uart_read_span(const uint8_t **span);
+void soft_uart_consume(size_t len);
 void uart_bitbang_send_string(const char *str, size_t length);
+size_t soft_uart_write(const void *data, size_t len);
+bool soft_uart_tx_wait(TickType_t timeout);
+esp_err_t init_transmit(void);
 IRAM_ATTR void uart_rx_isr_handler(void *arg);
-extern volatile bool start_bit_detected;
-extern bool stop_bit;
-extern uint8_t received_data[BUFFER_SIZE];
+IRAM_ATTR int soft_uart_rx_sample(soft_uart_rx_t *rx, int votes);
+void soft_uart_rx_get_stats(soft_uart_rx_stats_t *out);
+const soft_uart_timing_t* soft_uart_timing(uint32_t baud);
+esp_err_t soft_uart_set_baud(uint32_t rx_baud, uint32_t tx_baud);
+uint32_t soft_uart_autobaud(uint32_t window_ms);
 extern uint8_t TX_PIN;
 
-#else
-#include "UART_tests.h"
-#endif
-
 #endif  // RECIVE_UART_H
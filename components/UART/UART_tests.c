@@ -0,0 +1,406 @@
+/**
+ * @file UART_tests.c
+ * @author yassine hattay
+ * @brief Cycle-level model of the ESP8266 under the soft UART (`TEST_ON_PC`).
+ *
+ * Time is counted in CPU cycles. Code between SDK calls is free; each
+ * modelled operation (CCOUNT read, GPIO access, interrupt entry and exit)
+ * advances the clock by a fixed cost, so spin loops terminate and the
+ * sampling instants drift the way they do on the chip. Interrupts never
+ * nest: an edge or a timer expiry during a handler is taken after it
+ * returns, and FRC1 periods missed meanwhile collapse into one.
+ *
+ * Writing the FRC1 load register restarts the count, as on the chip.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "UART.h"
+
+#if TEST_ON_PC == 1
+#include <stdlib.h>
+
+#define SIM_CCOUNT_CYCLES 4      ///< One CCOUNT read in a spin loop
+#define SIM_GPIO_CYCLES 20       ///< One gpio_get_level() / gpio_set_level() call
+#define SIM_ISR_EXIT_CYCLES 60   ///< Register restore and return from an interrupt
+#define SIM_TX_EDGES_MAX 65536   ///< TX_PIN transitions recorded per run
+
+/** @brief State of the simulated chip */
+static struct {
+	uint64_t now;                ///< CPU cycles since sim_reset()
+	uint32_t mhz;
+	uint32_t edge_latency;       ///< Edge to GPIO handler entry (cycles)
+	uint32_t timer_latency;      ///< FRC1 expiry to handler entry (cycles)
+	uint32_t jitter;             ///< Extra random entry delay, up to (cycles)
+	uint32_t seed;
+
+	uint64_t *rx_times;          ///< Waveform on RX_PIN
+	uint8_t *rx_levels;
+	size_t rx_count;
+	size_t rx_next;              ///< First transition still ahead of `now`
+	int rx_level;
+
+	gpio_int_type_t intr_type;
+	bool edge_pending;
+	gpio_isr_t gpio_isr;
+	void *gpio_arg;
+
+	void (*timer_cb)(void *arg);
+	void *timer_arg;
+	bool timer_on;
+	bool reload;
+	uint32_t load;               ///< 80 MHz ticks
+	uint64_t timer_due;
+
+	int tx_level;
+	uint64_t tx_times[SIM_TX_EDGES_MAX];
+	uint8_t tx_levels[SIM_TX_EDGES_MAX];
+	size_t tx_count;
+
+	bool notified;
+	bool stop_on_notify;         ///< A task is blocked in ulTaskNotifyTake()
+	uint64_t isr_cycles;         ///< Entry to exit, latency included
+	uint32_t isr_count;
+} s_sim = { .mhz = 160, .rx_level = 1, .tx_level = 1 };
+
+/**
+ * @brief FRC1 ticks (80 MHz) in CPU cycles.
+ */
+static uint64_t sim_ticks_to_cycles(uint32_t ticks) {
+	return (uint64_t) ticks * s_sim.mhz / 80;
+}
+
+/**
+ * @brief CPU cycles per RTOS tick.
+ */
+static uint64_t sim_cycles_per_tick(void) {
+	return (uint64_t) s_sim.mhz * 1000000 / configTICK_RATE_HZ;
+}
+
+/**
+ * @brief Random interrupt entry delay in [0, jitter] cycles.
+ */
+static uint32_t sim_jitter(void) {
+	if (s_sim.jitter == 0)
+		return 0;
+	s_sim.seed = s_sim.seed * 1103515245 + 12345;
+	return (s_sim.seed >> 8) % (s_sim.jitter + 1);
+}
+
+/**
+ * @brief Whether a transition of RX_PIN raises the armed edge interrupt.
+ */
+static bool sim_edge_matches(int from, int to) {
+	switch (s_sim.intr_type) {
+	case GPIO_INTR_NEGEDGE:
+		return from && !to;
+	case GPIO_INTR_POSEDGE:
+		return !from && to;
+	case GPIO_INTR_ANYEDGE:
+		return from != to;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Moves RX_PIN up to `now`, latching the edge interrupt.
+ */
+static void sim_line_update(void) {
+	while (s_sim.rx_next < s_sim.rx_count
+			&& s_sim.rx_times[s_sim.rx_next] <= s_sim.now) {
+		int level = s_sim.rx_levels[s_sim.rx_next++];
+		if (sim_edge_matches(s_sim.rx_level, level))
+			s_sim.edge_pending = true;
+		s_sim.rx_level = level;
+	}
+}
+
+/**
+ * @brief Time of the next edge interrupt, UINT64_MAX if none is armed.
+ */
+static uint64_t sim_next_edge(void) {
+	if (s_sim.edge_pending)
+		return s_sim.now;
+	if (s_sim.intr_type == GPIO_INTR_DISABLE)
+		return UINT64_MAX;
+
+	int level = s_sim.rx_level;
+	for (size_t i = s_sim.rx_next; i < s_sim.rx_count; i++) {
+		if (sim_edge_matches(level, s_sim.rx_levels[i]))
+			return s_sim.rx_times[i];
+		level = s_sim.rx_levels[i];
+	}
+	return UINT64_MAX;
+}
+
+/**
+ * @brief Resets the clock, the pins and the counters.
+ *
+ * Handlers and the armed edge type survive, like the firmware state that
+ * registered them.
+ *
+ * @param cpu_mhz       80 or 160.
+ * @param edge_latency  Edge to GPIO handler entry (cycles).
+ * @param timer_latency FRC1 expiry to handler entry (cycles).
+ * @param jitter        Extra random entry delay, up to (cycles).
+ * @param seed          Seed of the entry delay.
+ */
+void sim_reset(uint32_t cpu_mhz, uint32_t edge_latency, uint32_t timer_latency,
+		uint32_t jitter, uint32_t seed) {
+	s_sim.now = 0;
+	s_sim.mhz = cpu_mhz;
+	s_sim.edge_latency = edge_latency;
+	s_sim.timer_latency = timer_latency;
+	s_sim.jitter = jitter;
+	s_sim.seed = seed;
+	sim_load_rx(NULL, NULL, 0);
+	s_sim.edge_pending = false;
+	s_sim.timer_on = false;
+	s_sim.tx_count = 0;
+	s_sim.notified = false;
+	s_sim.isr_cycles = 0;
+	s_sim.isr_count = 0;
+}
+
+/**
+ * @brief Loads the RX_PIN waveform, copied.
+ *
+ * @param times  Transition times in CPU cycles, ascending.
+ * @param levels Line level from each transition on.
+ * @param count  Number of transitions; the line idles high before the first.
+ * @return false if out of memory.
+ */
+bool sim_load_rx(const uint64_t *times, const uint8_t *levels, size_t count) {
+	free(s_sim.rx_times);
+	free(s_sim.rx_levels);
+	s_sim.rx_times = NULL;
+	s_sim.rx_levels = NULL;
+	s_sim.rx_count = 0;
+	s_sim.rx_next = 0;
+	s_sim.rx_level = 1;
+	if (count == 0)
+		return true;
+
+	s_sim.rx_times = malloc(count * sizeof(uint64_t));
+	s_sim.rx_levels = malloc(count);
+	if (s_sim.rx_times == NULL || s_sim.rx_levels == NULL) {
+		printf("sim_load_rx: %u transitions do not fit\n", (unsigned) count);
+		sim_load_rx(NULL, NULL, 0);
+		return false;
+	}
+	memcpy(s_sim.rx_times, times, count * sizeof(uint64_t));
+	memcpy(s_sim.rx_levels, levels, count);
+	s_sim.rx_count = count;
+	return true;
+}
+
+/**
+ * @brief Runs the interrupts due up to CPU cycle `until`.
+ *
+ * Stops early when a blocked task is notified.
+ */
+void sim_run(uint64_t until) {
+	while (1) {
+		sim_line_update();
+		uint64_t edge = sim_next_edge();
+		uint64_t timer = s_sim.timer_on ? s_sim.timer_due : UINT64_MAX;
+		uint64_t due = edge < timer ? edge : timer;
+		if (due > until)
+			break;
+
+		if (due > s_sim.now)
+			s_sim.now = due;
+		sim_line_update();
+
+		uint64_t start = s_sim.now;
+		if (timer <= edge) {
+			s_sim.now += s_sim.timer_latency + sim_jitter();
+			if (s_sim.reload)
+				s_sim.timer_due += sim_ticks_to_cycles(s_sim.load);
+			else
+				s_sim.timer_on = false;
+			s_sim.timer_cb(s_sim.timer_arg);
+		} else {
+			s_sim.now += s_sim.edge_latency + sim_jitter();
+			s_sim.edge_pending = false;
+			s_sim.gpio_isr(s_sim.gpio_arg);
+		}
+		s_sim.now += SIM_ISR_EXIT_CYCLES;
+		s_sim.isr_cycles += s_sim.now - start;
+		s_sim.isr_count++;
+
+		// Periods that ran out during the handler latch a single interrupt
+		uint64_t period = sim_ticks_to_cycles(s_sim.load);
+		while (s_sim.timer_on && period > 0
+				&& s_sim.timer_due + period <= s_sim.now)
+			s_sim.timer_due += period;
+
+		if (s_sim.stop_on_notify && s_sim.notified)
+			return;
+	}
+	if (s_sim.now < until) {
+		s_sim.now = until;
+		sim_line_update();
+	}
+}
+
+/**
+ * @brief Current CPU cycle.
+ */
+uint64_t sim_now(void) {
+	return s_sim.now;
+}
+
+/**
+ * @brief CCOUNT register, each read costs `SIM_CCOUNT_CYCLES`.
+ */
+uint32_t sim_ccount(void) {
+	s_sim.now += SIM_CCOUNT_CYCLES;
+	return (uint32_t) s_sim.now;
+}
+
+/**
+ * @brief Cycles spent in interrupts since sim_reset().
+ */
+uint64_t sim_isr_cycles(void) {
+	return s_sim.isr_cycles;
+}
+
+/**
+ * @brief Interrupts taken since sim_reset().
+ */
+uint32_t sim_isr_count(void) {
+	return s_sim.isr_count;
+}
+
+/**
+ * @brief Copies the TX_PIN transitions recorded since sim_reset().
+ *
+ * @return Number of transitions copied.
+ */
+size_t sim_tx_edges(uint64_t *times, uint8_t *levels, size_t max) {
+	size_t n = s_sim.tx_count < max ? s_sim.tx_count : max;
+	memcpy(times, s_sim.tx_times, n * sizeof(uint64_t));
+	memcpy(levels, s_sim.tx_levels, n);
+	return n;
+}
+
+esp_err_t gpio_config(const gpio_config_t *conf) {
+	if (conf->pin_bit_mask & (1UL << RX_PIN))
+		s_sim.intr_type = conf->intr_type;
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+	s_sim.now += SIM_GPIO_CYCLES;
+	if (gpio_num != TX_PIN || (int) level == s_sim.tx_level)
+		return ESP_OK;
+
+	s_sim.tx_level = level;
+	if (s_sim.tx_count < SIM_TX_EDGES_MAX) {
+		s_sim.tx_times[s_sim.tx_count] = s_sim.now;
+		s_sim.tx_levels[s_sim.tx_count++] = level;
+	}
+	return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+	s_sim.now += SIM_GPIO_CYCLES;
+	sim_line_update();
+	return gpio_num == RX_PIN ? s_sim.rx_level : s_sim.tx_level;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+	s_sim.now += SIM_GPIO_CYCLES;
+	sim_line_update(); // edges so far count against the old type
+	s_sim.intr_type = intr_type;
+	s_sim.edge_pending = false;
+	return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int no_use) {
+	return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler,
+		void *args) {
+	s_sim.gpio_isr = isr_handler;
+	s_sim.gpio_arg = args;
+	return ESP_OK;
+}
+
+esp_err_t hw_timer_init(void (*callback)(void *arg), void *arg) {
+	s_sim.timer_cb = callback;
+	s_sim.timer_arg = arg;
+	return ESP_OK;
+}
+
+esp_err_t hw_timer_set_clkdiv(hw_timer_clkdiv_t clkdiv) {
+	return clkdiv == TIMER_CLKDIV_1 ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t hw_timer_set_intr_type(hw_timer_intr_type_t intr_type) {
+	return ESP_OK;
+}
+
+esp_err_t hw_timer_set_reload(bool reload) {
+	s_sim.reload = reload;
+	return ESP_OK;
+}
+
+esp_err_t hw_timer_set_load_data(uint32_t load_data) {
+	s_sim.load = load_data;
+	if (s_sim.timer_on)
+		s_sim.timer_due = s_sim.now + sim_ticks_to_cycles(load_data);
+	return ESP_OK;
+}
+
+esp_err_t hw_timer_enable(bool en) {
+	if (en && !s_sim.timer_on)
+		s_sim.timer_due = s_sim.now + sim_ticks_to_cycles(s_sim.load);
+	s_sim.timer_on = en;
+	return ESP_OK;
+}
+
+TickType_t xTaskGetTickCount(void) {
+	return (TickType_t) (s_sim.now / sim_cycles_per_tick());
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	return &s_sim;
+}
+
+void vTaskDelay(TickType_t ticks) {
+	sim_run(s_sim.now + ticks * sim_cycles_per_tick());
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+	if (!s_sim.notified) {
+		s_sim.stop_on_notify = true;
+		sim_run(s_sim.now + ticks * sim_cycles_per_tick());
+		s_sim.stop_on_notify = false;
+	}
+	uint32_t taken = s_sim.notified;
+	s_sim.notified = false;
+	return taken;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+	s_sim.notified = true;
+	*woken = pdTRUE;
+}
+
+void ets_delay_us(uint32_t us) {
+	s_sim.now += (uint64_t) us * s_sim.mhz;
+}
+
+uint32_t power_cpu_mhz(void) {
+	return s_sim.mhz;
+}
+#endif
@@ -0,0 +1,128 @@
+/**
+ * @file UART_tests.h
+ * @author yassine hattay
+ * @brief Host stand-ins for the SDK calls of the soft UART (`TEST_ON_PC`).
+ *
+ * Only the types, constants and functions `UART.c` uses are declared. They
+ * are implemented in `UART_tests.c` by a cycle-level model of the chip:
+ * - CCOUNT is a simulated clock advanced by every modelled operation.
+ * - `RX_PIN` follows a waveform loaded with `sim_load_rx()` and raises
+ *   the GPIO edge interrupt; `TX_PIN` transitions are recorded.
+ * - FRC1 fires `hw_timer_init()`'s callback at 80 MHz ticks.
+ * - Task notifications and delays run the simulation until they are due.
+ *
+ * `host_soft_uart.py` drives it to measure receiver byte errors and
+ * interrupt cycles under baud mismatch, jitter and glitches.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef UART_TESTS_H_
+#define UART_TESTS_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define IRAM_ATTR
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL (-1)
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_NOT_SUPPORTED 0x106
+
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+typedef int BaseType_t;
+#define pdFALSE 0
+#define pdTRUE 1
+#define portMAX_DELAY ((TickType_t) 0xffffffffUL)
+#define configTICK_RATE_HZ 1000 // CONFIG_FREERTOS_HZ of sdkconfig
+#define pdMS_TO_TICKS(ms) ((TickType_t) ((uint64_t) (ms) * configTICK_RATE_HZ / 1000))
+#define portYIELD_FROM_ISR() do { } while (0)
+#define taskENTER_CRITICAL() do { } while (0) // interrupts only run inside sim_run()
+#define taskEXIT_CRITICAL() do { } while (0)
+
+typedef enum {
+	GPIO_NUM_2 = 2, GPIO_NUM_12 = 12
+} gpio_num_t;
+
+typedef enum {
+	GPIO_MODE_DISABLE = 0, GPIO_MODE_INPUT, GPIO_MODE_OUTPUT
+} gpio_mode_t;
+
+typedef enum {
+	GPIO_PULLUP_DISABLE = 0, GPIO_PULLUP_ENABLE
+} gpio_pullup_t;
+
+typedef enum {
+	GPIO_PULLDOWN_DISABLE = 0, GPIO_PULLDOWN_ENABLE
+} gpio_pulldown_t;
+
+typedef enum {
+	GPIO_INTR_DISABLE = 0,
+	GPIO_INTR_POSEDGE,
+	GPIO_INTR_NEGEDGE,
+	GPIO_INTR_ANYEDGE,
+	GPIO_INTR_LOW_LEVEL,
+	GPIO_INTR_HIGH_LEVEL
+} gpio_int_type_t;
+
+typedef struct {
+	uint32_t pin_bit_mask;
+	gpio_mode_t mode;
+	gpio_pullup_t pull_up_en;
+	gpio_pulldown_t pull_down_en;
+	gpio_int_type_t intr_type;
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)(void *arg);
+
+typedef enum {
+	TIMER_CLKDIV_1 = 0, TIMER_CLKDIV_16 = 4, TIMER_CLKDIV_256 = 8
+} hw_timer_clkdiv_t;
+
+typedef enum {
+	TIMER_EDGE_INT = 0, TIMER_LEVEL_INT = 1
+} hw_timer_intr_type_t;
+
+esp_err_t gpio_config(const gpio_config_t *conf);
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+int gpio_get_level(gpio_num_t gpio_num);
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+esp_err_t gpio_install_isr_service(int no_use);
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler,
+		void *args);
+
+esp_err_t hw_timer_init(void (*callback)(void *arg), void *arg);
+esp_err_t hw_timer_set_clkdiv(hw_timer_clkdiv_t clkdiv);
+esp_err_t hw_timer_set_intr_type(hw_timer_intr_type_t intr_type);
+esp_err_t hw_timer_set_reload(bool reload);
+esp_err_t hw_timer_set_load_data(uint32_t load_data);
+esp_err_t hw_timer_enable(bool en);
+
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void vTaskDelay(TickType_t ticks);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+void ets_delay_us(uint32_t us);
+uint32_t power_cpu_mhz(void);
+
+/* Simulation control, called by host_soft_uart.py */
+void sim_reset(uint32_t cpu_mhz, uint32_t edge_latency, uint32_t timer_latency,
+		uint32_t jitter, uint32_t seed);
+bool sim_load_rx(const uint64_t *times, const uint8_t *levels, size_t count);
+void sim_run(uint64_t until);
+uint64_t sim_now(void);
+uint32_t sim_ccount(void);
+uint64_t sim_isr_cycles(void);
+uint32_t sim_isr_count(void);
+size_t sim_tx_edges(uint64_t *times, uint8_t *levels, size_t max);
+
+#endif /* UART_TESTS_H_ */
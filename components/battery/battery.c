@@ -0,0 +1,163 @@
+/**
+ * @file battery.c
+ * @author yassine hattay
+ * @brief Background battery monitor for ESP12/ESP8266.
+ *
+ * A low-priority FreeRTOS task periodically takes `BATTERY_OVERSAMPLE` ADC
+ * reads, decimates them to 12 bits and converts the result to millivolts
+ * with integer math only. Unloaded samples feed a fixed-point EMA that other
+ * tasks read instantly through `battery_get_mv()`. Every sample is also kept
+ * in a short history tagged with the SIM800 load state so the sag during
+ * transmission can be reported by `battery_get_sag_mv()`.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "battery.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/adc.h"
+#include "../task_registry/task_registry.h"
+#include <stdio.h>
+
+/** @brief One decimated sample in the sag history */
+typedef struct {
+	uint16_t mv;     ///< Battery voltage (millivolts)
+	uint8_t loaded;  ///< 1 if taken while the SIM800 was powered/transmitting
+} battery_sample_t;
+
+/** @brief Filtered unloaded voltage in Q4 millivolts (0 until first sample) */
+static volatile uint32_t s_ema_mv_q4 = 0;
+
+/** @brief Set by the SIM800 driver while the modem draws current */
+static volatile bool s_loaded = false;
+
+static battery_sample_t s_history[BATTERY_HISTORY_LEN];
+static uint8_t s_history_pos = 0;
+static uint8_t s_history_count = 0;
+
+/**
+ * @brief Takes one oversampled, decimated battery measurement.
+ *
+ * Sums `BATTERY_OVERSAMPLE` back-to-back ADC reads and shifts away the
+ * noise bits, leaving a 12-bit code that is scaled to millivolts with the
+ * Q16 constant `BATTERY_MV_PER_LSB_Q16`.
+ *
+ * @return Battery voltage in millivolts, or 0 if every ADC read failed.
+ */
+static uint32_t battery_sample_mv(void) {
+	uint32_t sum = 0;
+	int valid = 0;
+
+	for (int i = 0; i < BATTERY_OVERSAMPLE; i++) {
+		uint16_t adc_val;
+		if (adc_read(&adc_val) == ESP_OK) {
+			sum += adc_val;
+			valid++;
+		}
+	}
+	if (valid == 0)
+		return 0;
+
+	// Rescale partial bursts so the decimation shift stays exact
+	if (valid != BATTERY_OVERSAMPLE)
+		sum = sum * BATTERY_OVERSAMPLE / valid;
+
+	uint32_t code = sum >> BATTERY_EXTRA_BITS;
+	return (code * BATTERY_MV_PER_LSB_Q16) >> (16 + BATTERY_EXTRA_BITS);
+}
+
+/**
+ * @brief FreeRTOS task sampling the battery in the background.
+ *
+ * Every `BATTERY_PERIOD_MS` it records a decimated sample in the history and,
+ * when the SIM800 is not loading the battery, updates the EMA with
+ * alpha = 1 / 2^`BATTERY_EMA_SHIFT`. The first sample seeds the filter.
+ *
+ * @param arg Task argument (unused).
+ */
+static void battery_task(void *arg) {
+	while (1) {
+		uint32_t mv = battery_sample_mv();
+		bool loaded = s_loaded;
+
+		if (mv > 0) {
+			s_history[s_history_pos].mv = (uint16_t) mv;
+			s_history[s_history_pos].loaded = loaded;
+			s_history_pos = (s_history_pos + 1) % BATTERY_HISTORY_LEN;
+			if (s_history_count < BATTERY_HISTORY_LEN)
+				s_history_count++;
+
+			if (!loaded) {
+				int32_t ema = s_ema_mv_q4;
+				if (ema == 0)
+					ema = mv << 4;
+				else
+					ema += ((int32_t) (mv << 4) - ema) >> BATTERY_EMA_SHIFT;
+				s_ema_mv_q4 = ema;
+			}
+		}
+
+		vTaskDelay(pdMS_TO_TICKS(BATTERY_PERIOD_MS));
+	}
+}
+
+/**
+ * @brief Starts the background battery monitor task.
+ *
+ * @return `ESP_OK` on success, `ESP_FAIL` if the task could not be created.
+ */
+esp_err_t battery_monitor_start(void) {
+	if (task_registry_create(TASK_ID_BATTERY, battery_task, NULL) == NULL) {
+		printf("battery_monitor_start: Task creation failed\n");
+		return ESP_FAIL;
+	}
+	return ESP_OK;
+}
+
+/**
+ * @brief Returns the latest filtered (unloaded) battery voltage.
+ *
+ * Non-blocking once the monitor has produced its first sample. If called
+ * before that, a single oversampled measurement is taken synchronously.
+ *
+ * @return Battery voltage in millivolts.
+ */
+uint32_t battery_get_mv(void) {
+	uint32_t ema = s_ema_mv_q4;
+	if (ema == 0)
+		return battery_sample_mv();
+	return (ema + 8) >> 4;
+}
+
+/**
+ * @brief Returns the voltage sag observed while the SIM800 was loaded.
+ *
+ * Computed as the filtered unloaded voltage minus the lowest loaded sample
+ * still in the history.
+ *
+ * @return Sag in millivolts, or 0 if no loaded sample is in the history.
+ */
+uint32_t battery_get_sag_mv(void) {
+	uint32_t rest = battery_get_mv();
+	uint32_t min_loaded = UINT32_MAX;
+
+	for (int i = 0; i < s_history_count; i++) {
+		if (s_history[i].loaded && s_history[i].mv < min_loaded)
+			min_loaded = s_history[i].mv;
+	}
+
+	if (min_loaded == UINT32_MAX || min_loaded >= rest)
+		return 0;
+	return rest - min_loaded;
+}
+
+/**
+ * @brief Tags subsequent samples as taken under SIM800 load or at rest.
+ *
+ * @param loaded true while the SIM800 is powered/transmitting.
+ */
+void battery_set_load(bool loaded) {
+	s_loaded = loaded;
+}
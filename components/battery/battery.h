@@ -0,0 +1,68 @@
+/**
+ * @file battery.h
+ * @author yassine hattay
+ * @brief Background battery monitor for ESP12/ESP8266.
+ *
+ * This module samples the battery voltage on the ADC (A0 / TOUT) in a
+ * low-priority task while the rest of the system is busy (e.g. GPS
+ * acquisition):
+ * - Oversamples and decimates the 10-bit ADC to 12 bits.
+ * - Converts to millivolts and filters with a fixed-point EMA.
+ * - Keeps a short history tagged with the SIM800 load state to estimate the
+ *   voltage sag while the modem transmits.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef BATTERY_H_
+#define BATTERY_H_
+
+#include "../my_config/my_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#if TEST_ON_PC == 0
+#include "esp_err.h"
+#endif
+
+/** @brief Number of raw ADC reads summed per decimated sample (4^2 -> +2 bits) */
+#define BATTERY_OVERSAMPLE 16
+
+/** @brief Extra resolution bits gained by oversampling */
+#define BATTERY_EXTRA_BITS 2
+
+/** @brief Period between decimated samples (milliseconds) */
+#define BATTERY_PERIOD_MS 250
+
+/** @brief EMA smoothing shift, alpha = 1 / 2^shift */
+#define BATTERY_EMA_SHIFT 3
+
+/** @brief Number of decimated samples kept for sag estimation */
+#define BATTERY_HISTORY_LEN 16
+
+/** @brief ADC code measured for BATTERY_ADC_REF_MV at the A0 pin */
+#define BATTERY_ADC_REF_CODE 738
+
+/** @brief Voltage at the A0 pin giving BATTERY_ADC_REF_CODE (millivolts) */
+#define BATTERY_ADC_REF_MV 800
+
+/** @brief Resistor divider ratio from battery to A0 (per mille) */
+#define BATTERY_DIVIDER_PERMILLE 258
+
+/** @brief Battery millivolts per ADC LSB in Q16 fixed point */
+#define BATTERY_MV_PER_LSB_Q16 \
+	((uint32_t) ((BATTERY_ADC_REF_MV * 65536ULL * 1000) \
+			/ (BATTERY_ADC_REF_CODE * BATTERY_DIVIDER_PERMILLE)))
+
+/** @brief Battery voltage considered low (millivolts) */
+#define BATTERY_LOW_MV 3400
+
+#if TEST_ON_PC == 0
+esp_err_t battery_monitor_start(void);
+#endif
+uint32_t battery_get_mv(void);
+uint32_t battery_get_sag_mv(void);
+void battery_set_load(bool loaded);
+
+#endif /* BATTERY_H_ */
@@ -0,0 +1,62 @@
+/**
+ * @file boot_timeline.c
+ * @author yassine hattay
+ * @brief Boot timeline instrumentation for ESP12/ESP8266.
+ *
+ * Marks are stored as raw CCOUNT values with a static label and converted
+ * to microseconds only when the timeline is printed, after the boot path
+ * has finished.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "boot_timeline.h"
+#include <stdio.h>
+
+/** @brief One timeline entry */
+typedef struct {
+	const char *label; ///< Static string, not copied
+	uint32_t ccount;   ///< CPU cycle counter when the mark was taken
+} boot_timeline_entry_t;
+
+static boot_timeline_entry_t s_marks[BOOT_TIMELINE_MAX_MARKS];
+static int s_count = 0;
+
+/**
+ * @brief Records a timeline mark.
+ *
+ * The first mark is the origin of the timeline and should be taken on
+ * `app_main` entry. Task context only, not thread-safe.
+ *
+ * @param label Name of the step that just finished (static string).
+ */
+void boot_timeline_mark(const char *label) {
+	if (s_count >= BOOT_TIMELINE_MAX_MARKS)
+		return;
+
+	s_marks[s_count].ccount = boot_timeline_ccount();
+	s_marks[s_count].label = label;
+	s_count++;
+}
+
+/**
+ * @brief Prints the timeline to the console.
+ *
+ * One "Boot:" line per mark gives its time since `app_main` entry and the
+ * duration of the step it closes. The cycle count on entry (reset, ROM and
+ * bootloader) is printed first.
+ */
+void boot_timeline_report(void) {
+	if (s_count == 0)
+		return;
+
+	printf("Boot: reset to app_main %u cycles (%u us)\n", s_marks[0].ccount,
+			s_marks[0].ccount / BOOT_TIMELINE_CPU_MHZ);
+	for (int i = 1; i < s_count; i++) {
+		uint32_t at = s_marks[i].ccount - s_marks[0].ccount;
+		uint32_t step = s_marks[i].ccount - s_marks[i - 1].ccount;
+		printf("Boot: %-12s at %7u us (+%6u us)\n", s_marks[i].label,
+				at / BOOT_TIMELINE_CPU_MHZ, step / BOOT_TIMELINE_CPU_MHZ);
+	}
+}
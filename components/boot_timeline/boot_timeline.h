@@ -0,0 +1,43 @@
+/**
+ * @file boot_timeline.h
+ * @author yassine hattay
+ * @brief Boot timeline instrumentation for ESP12/ESP8266.
+ *
+ * Records named marks from the CPU cycle counter (CCOUNT) while `app_main`
+ * brings the system up, and prints them as one timeline:
+ * - A mark costs one register read, so it can sit between init steps
+ *   without skewing what it measures.
+ * - The first mark is taken on `app_main` entry; its CCOUNT value covers
+ *   the ROM and second-stage bootloader since reset.
+ * - CCOUNT wraps after ~26 s at 160 MHz, far longer than the boot path.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef BOOT_TIMELINE_H_
+#define BOOT_TIMELINE_H_
+
+#include "../my_config/my_config.h"
+#include <stdint.h>
+#include "sdkconfig.h"
+
+/** @brief Most marks kept per boot, later marks are dropped */
+#define BOOT_TIMELINE_MAX_MARKS 12
+
+/** @brief CPU clock used to convert cycles to microseconds (MHz) */
+#define BOOT_TIMELINE_CPU_MHZ CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ
+
+/**
+ * @brief Reads the CPU cycle counter.
+ */
+static inline uint32_t boot_timeline_ccount(void) {
+	uint32_t ccount;
+	__asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+	return ccount;
+}
+
+void boot_timeline_mark(const char *label);
+void boot_timeline_report(void);
+
+#endif /* BOOT_TIMELINE_H_ */
@@ -12,24 +12,89 @@
 
 #include "my_print.h"
 
-char log_buffer[LOG_BUFFER_SIZE];
-size_t log_index = 0;
-SemaphoreHandle_t log_mutex = NULL;
+/*
+ * RAM log: a ring written by any task, overwriting the oldest bytes. The
+ * counters run free over the boot, positions in `log_buffer` are masked.
+ */
+static char log_buffer[LOG_BUFFER_SIZE];
+static volatile uint32_t s_log_head = 0;      ///< Bytes reserved by writers
+static volatile uint32_t s_log_committed = 0; ///< Bytes readers may see
+static volatile uint32_t s_log_writers = 0;   ///< Reservations still copying
+static volatile uint32_t s_log_lost_end = 0;  ///< Bytes before this may be clobbered
+
+/** @brief Line being assembled for one task by the log sink */
+typedef struct {
+  volatile bool used;          ///< Claimed by `owner`, released once committed
+  volatile TaskHandle_t owner; ///< Task writing this line
+  size_t len;
+  char buf[LOG_LINE_SIZE];
+} log_line_t;
+
+static log_line_t s_lines[LOG_LINE_SLOTS];
+
+/**
+ * @brief Writes text to the console and the RAM log in one go.
+ */
+static void log_commit(const char *text, size_t len) {
+  fwrite(text, 1, len, stdout);
+  log_to_buffer(text, len);
+}
 
 /**
- * @brief Outputs a single character by forwarding it as a string to my_print.
+ * @brief Finds the line slot of the calling task, claiming a free one if it
+ * has none.
  *
- * Converts the input character to a null-terminated string and passes it to
- * my_print, mimicking the behavior of putchar for custom output handling.
+ * Only the owner writes to a claimed slot, so looking up its own slot needs
+ * no lock; claiming one is done in a critical section.
+ *
+ * @return The slot, or NULL if every slot is held by another task.
+ */
+static log_line_t *log_line_get(void) {
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+  for (size_t i = 0; i < LOG_LINE_SLOTS; i++)
+    if (s_lines[i].used && s_lines[i].owner == self)
+      return &s_lines[i];
+
+  log_line_t *line = NULL;
+  taskENTER_CRITICAL();
+  for (size_t i = 0; i < LOG_LINE_SLOTS; i++) {
+    if (!s_lines[i].used) {
+      line = &s_lines[i];
+      line->owner = self;
+      line->len = 0;
+      line->used = true;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL();
+  return line;
+}
+
+/**
+ * @brief ESP_LOG character sink, collects the output of each task into
+ * whole lines.
+ *
+ * A line is committed to the console and the RAM log at its `\n` or when
+ * `LOG_LINE_SIZE` characters are waiting, so logging costs one copy per
+ * line instead of a formatted print per character. Lines of concurrent
+ * tasks never interleave. If all `LOG_LINE_SLOTS` slots are busy, the
+ * character is passed straight through.
  */
 
 int my_custom_putchar(int c) {
-  // Create a string that contains the character
-  char char_str[2] = {
-      (char)c, '\0'}; // Create a string with one character and null-terminator
+  log_line_t *line = log_line_get();
+  if (line == NULL) {
+    char ch = (char) c;
+    log_commit(&ch, 1);
+    return c;
+  }
 
-  // Forward this string to my_print, assuming it works like printf
-  my_print("%s", char_str);
+  line->buf[line->len++] = (char) c;
+  if (c == '\n' || line->len == LOG_LINE_SIZE) {
+    log_commit(line->buf, line->len);
+    line->used = false;
+  }
 
   return c; // Return the character as required by putchar-like functions
 }
@@ -37,10 +102,8 @@ int my_custom_putchar(int c) {
 /**
  * @brief Initializes the custom print system.
  *
- * Sets up NVS flash, registers a custom putchar function for ESP logging,
- * and creates a mutex to ensure thread-safe logging.
- * This function must be called before using my_print in a multi-threaded
- * environment.
+ * Sets up NVS flash and registers a custom putchar function for ESP
+ * logging. The RAM log needs no lock, any task may log.
  */
 
 void my_print_init(void) {
@@ -48,33 +111,150 @@ void my_print_init(void) {
   ESP_ERROR_CHECK(nvs_flash_init());
 
   esp_log_set_putchar(my_custom_putchar);
-
-  log_mutex = xSemaphoreCreateMutex();
-  if (!log_mutex)
-    printf("Failed to create log mutex!\n");
 }
 
 /**
- * @brief Appends a message to the global log buffer in a thread-safe manner.
+ * @brief Appends a message to the RAM log, safe from any task.
  *
- * Acquires a mutex to safely append the input message to the log buffer.
- * If the buffer is full, it resets the buffer (simple overflow handling).
+ * The writer reserves its bytes by advancing `s_log_head`, copies them
+ * without any lock, then commits. The ESP8266 has no compare-and-swap, so
+ * reserve and commit are counter updates in a critical section of a few
+ * instructions; no writer ever waits for another. Readers see the new
+ * bytes once no reservation is still being copied. When the ring is full
+ * the oldest bytes are overwritten.
  *
- * @param msg The null-terminated message string to append.
+ * A writer preempted between reserve and copy for a whole ring of newer
+ * messages copies onto their bytes. The commit detects it and marks that
+ * range lost, so readers skip it instead of showing mixed text.
+ *
+ * @param msg The message to append, only its last `LOG_BUFFER_SIZE` bytes
+ *            are kept.
+ * @param len Its length, without a terminator.
  */
 
-void log_to_buffer(const char *msg) {
+void log_to_buffer(const char *msg, size_t len) {
+  if (len > LOG_BUFFER_SIZE) {
+    msg += len - LOG_BUFFER_SIZE;
+    len = LOG_BUFFER_SIZE;
+  }
+  if (len == 0)
+    return;
+
+  taskENTER_CRITICAL();
+  uint32_t pos = s_log_head;
+  s_log_head = pos + len;
+  s_log_writers++;
+  taskEXIT_CRITICAL();
 
+  size_t at = pos & (LOG_BUFFER_SIZE - 1);
+  size_t first = LOG_BUFFER_SIZE - at < len ? LOG_BUFFER_SIZE - at : len;
+  memcpy(log_buffer + at, msg, first);
+  memcpy(log_buffer, msg + first, len - first);
 
-  size_t len = strlen(msg);
-  if (log_index + len >= LOG_BUFFER_SIZE) {
-    // If full, reset (or you can implement ring buffer if you want)
-    log_index = 0;
-    memset(log_buffer, 0, sizeof(log_buffer));
+  taskENTER_CRITICAL();
+  if (s_log_head - pos > LOG_BUFFER_SIZE) {
+    // Our bytes already left the ring, the copy landed on newer ones
+    uint32_t clobbered = pos + len + LOG_BUFFER_SIZE;
+    if ((int32_t) (clobbered - s_log_head) > 0)
+      clobbered = s_log_head;
+    if ((int32_t) (clobbered - s_log_lost_end) > 0)
+      s_log_lost_end = clobbered;
   }
+  if (--s_log_writers == 0)
+    s_log_committed = s_log_head;
+  taskEXIT_CRITICAL();
+}
 
-  memcpy(log_buffer + log_index, msg, len);
-  log_index += len;
+/**
+ * @brief Oldest readable position for a head of `head`: still in the ring
+ * and past any range clobbered by a late writer.
+ */
+static uint32_t log_oldest(uint32_t head) {
+  uint32_t oldest = head > LOG_BUFFER_SIZE ? head - LOG_BUFFER_SIZE : 0;
+  uint32_t lost_end = s_log_lost_end;
+  return (int32_t) (lost_end - oldest) > 0 ? lost_end : oldest;
+}
+
+/**
+ * @brief Gives the committed RAM log in place, oldest first.
+ *
+ * The content is in at most two spans (before and after the end of the
+ * storage). Once the ring has wrapped it starts at the first full line.
+ * Writers are never held up: check `log_spans_intact()` after using the
+ * spans to know whether they were overwritten meanwhile.
+ *
+ * @param spans Filled with the spans.
+ */
+void log_get_spans(log_spans_t *spans) {
+  taskENTER_CRITICAL();
+  uint32_t head = s_log_head;
+  uint32_t end = s_log_committed;
+  taskEXIT_CRITICAL();
+
+  uint32_t start = log_oldest(head);
+  if ((int32_t) (end - start) < 0)
+    start = end;
+
+  // Wrapped: the first line lost its beginning
+  if (start > 0) {
+    while (start != end && log_buffer[start & (LOG_BUFFER_SIZE - 1)] != '\n')
+      start++;
+    if (start != end)
+      start++;
+  }
+
+  size_t at = start & (LOG_BUFFER_SIZE - 1);
+  size_t len = end - start;
+  spans->start = start;
+  spans->first = log_buffer + at;
+  spans->first_len = LOG_BUFFER_SIZE - at < len ? LOG_BUFFER_SIZE - at : len;
+  spans->second = log_buffer;
+  spans->second_len = len - spans->first_len;
+}
+
+/**
+ * @brief Whether the spans of `log_get_spans()` still hold what they held
+ * when taken.
+ */
+bool log_spans_intact(const log_spans_t *spans) {
+  return (int32_t) (spans->start - log_oldest(s_log_head)) >= 0;
+}
+
+/**
+ * @brief Copies the newest RAM log into `out_buffer`, NUL-terminated.
+ *
+ * Bytes overwritten by writers during the copy are dropped from the front.
+ *
+ * @param out_buffer Destination.
+ * @param max_len    Its size, terminator included.
+ */
+void get_logs(char *out_buffer, size_t max_len) {
+  if (max_len == 0)
+    return;
+
+  log_spans_t spans;
+  log_get_spans(&spans);
+
+  // Keep the newest bytes that fit
+  size_t total = spans.first_len + spans.second_len;
+  size_t skip = total > max_len - 1 ? total - (max_len - 1) : 0;
+  size_t first_skip = skip < spans.first_len ? skip : spans.first_len;
+  size_t n = spans.first_len - first_skip;
+  memcpy(out_buffer, spans.first + first_skip, n);
+  size_t second_skip = skip - first_skip;
+  memcpy(out_buffer + n, spans.second + second_skip,
+         spans.second_len - second_skip);
+  n += spans.second_len - second_skip;
+
+  uint32_t copied = spans.start + skip;
+  int32_t lost = (int32_t) (log_oldest(s_log_head) - copied);
+  if (lost > 0) {
+    if ((size_t) lost > n)
+      lost = n;
+    memmove(out_buffer, out_buffer + lost, n - lost);
+    n -= lost;
+  }
+  out_buffer[n] = '\0';
 }
 
 /**
@@ -92,10 +272,13 @@ void my_print(const char *format, ...) {
   va_list args;
 
   va_start(args, format);               // <-- THIS IS REQUIRED
-  vsnprintf(temp, sizeof(temp), format, args);
+  int len = vsnprintf(temp, sizeof(temp), format, args);
   va_end(args);
 
-  printf("%s", temp);
-  log_to_buffer(temp);
+  if (len <= 0)
+    return;
+  if ((size_t) len >= sizeof(temp))
+    len = sizeof(temp) - 1; // truncated
+  log_commit(temp, len);
 }
 
@@ -30,17 +30,33 @@ void my_print(const char *format, ...);
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 
 /** 
  * @brief  Size of the RAM log buffer .
  */
 
+#define LOG_BUFFER_SIZE 4096 // Size of the RAM log ring, a power of two
+#define LOG_LINE_SIZE 128    // Longest ESP_LOG line assembled before a commit
+#define LOG_LINE_SLOTS 4     // Tasks that can assemble a line at the same time
+
+/** @brief RAM log contents, in place in the ring, oldest first */
+typedef struct {
+  const char *first;  // Oldest bytes, up to the end of the storage
+  size_t first_len;
+  const char *second; // Continuation from the start of the storage
+  size_t second_len;
+  uint32_t start;     // Log position of `first`, for log_spans_intact()
+} log_spans_t;
+
 void my_print_init(void);
 void start_webserver(void);
-extern char log_buffer[];
-extern size_t log_index ;
-#define LOG_BUFFER_SIZE 4096 // Size of the RAM log buffer
+void log_to_buffer(const char *msg, size_t len);
+void log_get_spans(log_spans_t *spans);
+bool log_spans_intact(const log_spans_t *spans);
+void get_logs(char *out_buffer, size_t max_len);
 
 #else
 #include "my_print_test.h"
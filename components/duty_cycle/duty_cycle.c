@@ -0,0 +1,291 @@
+/**
+ * @file duty_cycle.c
+ * @author yassine hattay
+ * @brief Adaptive duty-cycle policy for the tracker's deep-sleep intervals.
+ *
+ * Every wake cycle ends with a call to `duty_cycle_sleep()`, which combines
+ * the cycle outcome with the state kept in RTC memory:
+ * - **Moving:** space reports `DUTY_TARGET_SPACING_M` apart at the current
+ *   speed, halve the interval in corners and double it on straight runs
+ *   (corner-aware sampling), or use `DUTY_MOVING_SLEEP_SEC` when slow.
+ * - **Stationary:** double the interval on each wake without displacement,
+ *   up to the reporting SLA.
+ * - **No fix / failed send:** exponential back-off from
+ *   `DUTY_NO_FIX_SLEEP_SEC` / `DUTY_FAIL_SLEEP_SEC`.
+ * - **Weak signal / low battery:** stretch the interval further.
+ *
+ * The policy itself is plain integer C so `host_duty_cycle.py` can build it
+ * with `-DTEST_ON_PC=1` and replay multi-day scenarios on the host.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "duty_cycle.h"
+#include "../geo/geo.h"
+#include "../rtc_state/rtc_state.h"
+#include <string.h>
+
+#if TEST_ON_PC == 0
+#include "esp_sleep.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "../battery/battery.h"
+#include "../report_filter/report_filter.h"
+#include "../rtc_clock/rtc_clock.h"
+#include "../energy/energy.h"
+#include <stdio.h>
+#endif
+
+/** @brief Policy state preserved across deep sleep */
+typedef struct {
+	uint32_t magic;
+	int32_t last_lat_e7;          ///< Last fix latitude (1e-7 deg)
+	int32_t last_lon_e7;          ///< Last fix longitude (1e-7 deg)
+	int32_t speed_cms;            ///< Last speed over ground (cm/s, -1 unknown)
+	int32_t course_cdeg;          ///< Last course (1/100 deg, -1 unknown)
+	uint8_t corner;               ///< 1 if the heading turned beyond DUTY_CORNER_CDEG
+	uint8_t straight_fixes;       ///< Consecutive fixes within DUTY_STRAIGHT_CDEG
+	uint8_t has_fix;              ///< 1 once a fix has been recorded
+	uint8_t moving;               ///< 1 if the last fix moved beyond the radius
+	uint8_t stationary_wakes;     ///< Consecutive fixes without displacement
+	uint8_t no_fix_streak;        ///< Consecutive GPS timeouts
+	uint8_t fail_streak;          ///< Consecutive failed SMS sessions
+	uint8_t csq_pos;              ///< Next slot in csq[]
+	uint8_t csq_count;            ///< Valid entries in csq[]
+	uint8_t csq[DUTY_CSQ_HISTORY];///< Recent AT+CSQ RSSI readings
+} duty_cycle_state_t;
+
+RTC_STATE(duty_cycle_state_t, s_state, 0x44435943);
+
+/**
+ * @brief Shifts a base interval left, saturating at a limit.
+ */
+static uint32_t scale_capped(uint32_t base, uint8_t shift, uint32_t limit) {
+	if (shift > 16)
+		shift = 16;
+	uint64_t v = (uint64_t) base << shift;
+	return v > limit ? limit : (uint32_t) v;
+}
+
+/**
+ * @brief Returns true if the recent signal history is weak or unknown.
+ */
+static bool duty_cycle_signal_weak(void) {
+	if (s_state.csq_count == 0)
+		return false;
+
+	uint32_t sum = 0;
+	for (int i = 0; i < s_state.csq_count; i++) {
+		uint8_t v = s_state.csq[i];
+		sum += (v == 99) ? 0 : v; // 99 = not detectable
+	}
+	return sum / s_state.csq_count < DUTY_WEAK_CSQ;
+}
+
+/**
+ * @brief Records a valid GPS fix and updates the motion state.
+ *
+ * The tracker counts as moving when the new fix lies more than
+ * `DUTY_MOVING_RADIUS_M` from the previous one. The first fix after a
+ * power-on counts as moving so the interval starts short. The heading
+ * change since the previous fix classifies the track as a corner or a
+ * straight run.
+ *
+ * @param lat_e7      Latitude in 1e-7 degrees.
+ * @param lon_e7      Longitude in 1e-7 degrees.
+ * @param speed_cms   Speed over ground in cm/s, or -1 if not reported.
+ * @param course_cdeg Course over ground in 1/100 degree, or -1 if not reported.
+ */
+void duty_cycle_record_fix(int32_t lat_e7, int32_t lon_e7, int32_t speed_cms,
+		int32_t course_cdeg) {
+	RTC_STATE_CLAIM(s_state);
+
+	s_state.corner = 0;
+	if (course_cdeg >= 0 && s_state.has_fix && s_state.course_cdeg >= 0
+			&& speed_cms >= DUTY_SLOW_SPEED_CMS) {
+		int32_t turn = geo_course_delta_cdeg(s_state.course_cdeg, course_cdeg);
+		if (turn < 0)
+			turn = -turn;
+
+		if (turn >= DUTY_CORNER_CDEG) {
+			s_state.corner = 1;
+			s_state.straight_fixes = 0;
+		} else if (turn <= DUTY_STRAIGHT_CDEG) {
+			if (s_state.straight_fixes < UINT8_MAX)
+				s_state.straight_fixes++;
+		} else {
+			s_state.straight_fixes = 0;
+		}
+	} else {
+		s_state.straight_fixes = 0;
+	}
+	s_state.speed_cms = speed_cms;
+	s_state.course_cdeg = course_cdeg;
+
+	if (s_state.has_fix) {
+		uint32_t d = geo_distance_m(s_state.last_lat_e7, s_state.last_lon_e7,
+				lat_e7, lon_e7);
+		s_state.moving = d > DUTY_MOVING_RADIUS_M;
+	} else {
+		s_state.moving = 1;
+	}
+
+	if (s_state.moving)
+		s_state.stationary_wakes = 0;
+	else if (s_state.stationary_wakes < UINT8_MAX)
+		s_state.stationary_wakes++;
+
+	s_state.last_lat_e7 = lat_e7;
+	s_state.last_lon_e7 = lon_e7;
+	s_state.has_fix = 1;
+	s_state.no_fix_streak = 0;
+}
+
+/**
+ * @brief Records a signal quality reading from `AT+CSQ`.
+ *
+ * @param csq RSSI value 0..31, or 99 if not detectable.
+ */
+void duty_cycle_record_signal(int csq) {
+	RTC_STATE_CLAIM(s_state);
+
+	if (csq < 0 || (csq > 31 && csq != 99))
+		return;
+	s_state.csq[s_state.csq_pos] = (uint8_t) csq;
+	s_state.csq_pos = (s_state.csq_pos + 1) % DUTY_CSQ_HISTORY;
+	if (s_state.csq_count < DUTY_CSQ_HISTORY)
+		s_state.csq_count++;
+}
+
+/**
+ * @brief Returns the motion state derived from the last two fixes.
+ */
+bool duty_cycle_is_moving(void) {
+	RTC_STATE_CLAIM(s_state);
+	return s_state.moving;
+}
+
+/**
+ * @brief Interval between reports while moving.
+ *
+ * At speed the interval targets `DUTY_TARGET_SPACING_M` between reported
+ * points, clamped to [`DUTY_MIN_SLEEP_SEC`, `DUTY_MAX_MOVING_SLEEP_SEC`].
+ * Corners halve it so the turn is captured; two or more straight fixes in a
+ * row double it since the track is well interpolated by fewer points.
+ */
+static uint32_t duty_cycle_moving_sleep_sec(void) {
+	if (s_state.speed_cms < DUTY_SLOW_SPEED_CMS)
+		return DUTY_MOVING_SLEEP_SEC;
+
+	uint32_t sleep_sec = DUTY_TARGET_SPACING_M * 100UL
+			/ (uint32_t) s_state.speed_cms;
+
+	if (s_state.corner)
+		sleep_sec /= 2;
+	else if (s_state.straight_fixes >= 2)
+		sleep_sec *= 2;
+
+	if (sleep_sec < DUTY_MIN_SLEEP_SEC)
+		sleep_sec = DUTY_MIN_SLEEP_SEC;
+	if (sleep_sec > DUTY_MAX_MOVING_SLEEP_SEC)
+		sleep_sec = DUTY_MAX_MOVING_SLEEP_SEC;
+	return sleep_sec;
+}
+
+/**
+ * @brief Picks the next deep-sleep duration.
+ *
+ * @param outcome    How the current wake cycle ended.
+ * @param battery_mv Current battery voltage (0 if unknown).
+ * @return Sleep duration in seconds.
+ */
+uint32_t duty_cycle_next_sleep_sec(duty_cycle_outcome_t outcome,
+		uint32_t battery_mv) {
+	RTC_STATE_CLAIM(s_state);
+
+	uint32_t sleep_sec;
+	bool weak = duty_cycle_signal_weak();
+
+	switch (outcome) {
+	case DUTY_OUTCOME_REPORTED:
+	case DUTY_OUTCOME_SUPPRESSED:
+		if (outcome == DUTY_OUTCOME_REPORTED)
+			s_state.fail_streak = 0;
+		if (s_state.moving)
+			sleep_sec = duty_cycle_moving_sleep_sec();
+		else
+			sleep_sec = scale_capped(DUTY_MOVING_SLEEP_SEC,
+					s_state.stationary_wakes, DUTY_SLA_SEC);
+		// Fewer, more reliable sessions when every send is expensive
+		if (weak)
+			sleep_sec = scale_capped(sleep_sec, 1, DUTY_SLA_SEC);
+		break;
+
+	case DUTY_OUTCOME_NO_FIX:
+		if (s_state.no_fix_streak < UINT8_MAX)
+			s_state.no_fix_streak++;
+		sleep_sec = scale_capped(DUTY_NO_FIX_SLEEP_SEC,
+				s_state.no_fix_streak - 1, DUTY_SLA_SEC);
+		break;
+
+	case DUTY_OUTCOME_SEND_FAILED:
+	default:
+		if (s_state.fail_streak < UINT8_MAX)
+			s_state.fail_streak++;
+		sleep_sec = scale_capped(DUTY_FAIL_SLEEP_SEC,
+				s_state.fail_streak - 1 + (weak ? 1 : 0), DUTY_SLA_SEC);
+		break;
+	}
+
+	if (battery_mv > 0 && battery_mv <= DUTY_BATTERY_CRITICAL_MV)
+		sleep_sec = scale_capped(sleep_sec, 2, DUTY_MAX_SLEEP_SEC);
+	else if (battery_mv > 0 && battery_mv <= DUTY_BATTERY_LOW_MV)
+		sleep_sec = scale_capped(sleep_sec, 1, DUTY_SLA_SEC);
+
+	return sleep_sec;
+}
+
+/**
+ * @brief Forgets all policy state (next decision starts from a cold boot).
+ */
+void duty_cycle_reset(void) {
+	RTC_STATE_FORGET(s_state);
+	RTC_STATE_CLAIM(s_state);
+}
+
+#if TEST_ON_PC == 0
+/**
+ * @brief Ends the wake cycle with a policy-chosen deep sleep.
+ *
+ * Reads the filtered battery voltage, picks the sleep duration for the given
+ * outcome, lets the RTC clock align it to a wall-clock boundary and correct
+ * it for timer drift, clamps it to `DUTY_MAX_TIMER_MS`, advances the report
+ * heartbeat timer by the time awake plus the sleep, records the sleep start
+ * and enters deep sleep.
+ * Does not return.
+ *
+ * @param outcome How the current wake cycle ended.
+ */
+void duty_cycle_sleep(duty_cycle_outcome_t outcome) {
+	uint32_t sleep_sec = duty_cycle_next_sleep_sec(outcome, battery_get_mv());
+	uint32_t timer_ms = rtc_clock_schedule_ms(sleep_sec);
+
+	if (timer_ms > DUTY_MAX_TIMER_MS) {
+		printf("duty_cycle_sleep: timer %u ms clamped to %u ms\n", timer_ms,
+				(uint32_t) DUTY_MAX_TIMER_MS);
+		timer_ms = DUTY_MAX_TIMER_MS;
+		sleep_sec = timer_ms / 1000;
+	}
+
+	report_filter_note_elapsed(
+			sleep_sec + xTaskGetTickCount() / configTICK_RATE_HZ);
+	rtc_clock_prepare_sleep(timer_ms);
+	energy_deep_sleep(timer_ms);
+
+	printf("Duty cycle: outcome %d, moving %d, deep sleeping for %u sec "
+			"(timer %u ms, drift %d ppm)...\n", outcome, s_state.moving,
+			sleep_sec, timer_ms, rtc_clock_drift_ppm());
+	esp_deep_sleep(timer_ms * 1000ULL);
+}
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file duty_cycle.h
+ * @author yassine hattay
+ * @brief Adaptive duty-cycle policy for the tracker's deep-sleep intervals.
+ *
+ * This module picks the next deep-sleep duration instead of fixed values:
+ * - Motion state from the distance between consecutive fixes.
+ * - Speed over ground and heading changes from the RMC sentence, so fast
+ *   or turning vehicles report more often and straight runs less often.
+ * - Battery voltage from the battery monitor.
+ * - Recent SIM800 signal quality (`AT+CSQ`) history.
+ * - A configured reporting SLA (maximum time between reports).
+ *
+ * Its state lives in RTC memory so it survives deep sleep.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef DUTY_CYCLE_H_
+#define DUTY_CYCLE_H_
+
+#include "../my_config/my_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** @brief Maximum time between two reports while fixes are available (seconds) */
+#define DUTY_SLA_SEC 3600
+
+/** @brief Sleep between reports while moving with unknown or low speed (seconds) */
+#define DUTY_MOVING_SLEEP_SEC 120
+
+/** @brief Shortest sleep between reports, used at speed and in corners (seconds) */
+#define DUTY_MIN_SLEEP_SEC 30
+
+/** @brief Longest sleep between reports while moving on a straight run (seconds) */
+#define DUTY_MAX_MOVING_SLEEP_SEC 600
+
+/** @brief Desired distance between reported points at speed (meters) */
+#define DUTY_TARGET_SPACING_M 1000
+
+/** @brief Speed below which spacing-based intervals are not used (cm/s, ~7 km/h) */
+#define DUTY_SLOW_SPEED_CMS 200
+
+/** @brief Heading change between fixes treated as a corner (1/100 degree) */
+#define DUTY_CORNER_CDEG 3000
+
+/** @brief Heading change between fixes still treated as straight (1/100 degree) */
+#define DUTY_STRAIGHT_CDEG 1000
+
+/** @brief Displacement between fixes above which the tracker counts as moving (meters) */
+#define DUTY_MOVING_RADIUS_M 50
+
+/** @brief First sleep after a GPS timeout, doubled on each consecutive one (seconds) */
+#define DUTY_NO_FIX_SLEEP_SEC 300
+
+/** @brief First sleep after a failed SMS session, doubled on each consecutive one (seconds) */
+#define DUTY_FAIL_SLEEP_SEC 60
+
+/** @brief Battery level below which intervals are doubled (millivolts) */
+#define DUTY_BATTERY_LOW_MV 3600
+
+/** @brief Battery level below which intervals are quadrupled and may exceed the SLA (millivolts) */
+#define DUTY_BATTERY_CRITICAL_MV 3400
+
+/** @brief Average CSQ below which the link counts as weak (0..31, 99 = unknown) */
+#define DUTY_WEAK_CSQ 8
+
+/** @brief Number of CSQ readings kept in RTC memory */
+#define DUTY_CSQ_HISTORY 4
+
+/** @brief Hard upper bound of a single deep sleep (seconds) */
+#define DUTY_MAX_SLEEP_SEC (4 * DUTY_SLA_SEC)
+
+/**
+ * @brief Longest timer request passed to `esp_deep_sleep()` (milliseconds).
+ *
+ * The ESP8266 RTC timer is a 32-bit count of the ~150 kHz RTC clock and
+ * overflows after roughly 3.5 to 4 hours, depending on its calibration.
+ * Requests are clamped to 3 hours after drift correction and alignment;
+ * a clamped sleep simply wakes early and the next cycle realigns.
+ */
+#define DUTY_MAX_TIMER_MS (3 * 3600 * 1000UL)
+
+/** @brief Outcome of the current wake cycle, used to pick the next sleep */
+typedef enum {
+	DUTY_OUTCOME_REPORTED = 0,  ///< A fix was reported over SMS
+	DUTY_OUTCOME_NO_FIX,        ///< The GPS timed out (cell fallback may have run)
+	DUTY_OUTCOME_SEND_FAILED,   ///< The SIM800 could not register or send
+	DUTY_OUTCOME_SUPPRESSED,    ///< A fix was obtained but not worth reporting
+} duty_cycle_outcome_t;
+
+void duty_cycle_record_fix(int32_t lat_e7, int32_t lon_e7, int32_t speed_cms,
+		int32_t course_cdeg);
+void duty_cycle_record_signal(int csq);
+bool duty_cycle_is_moving(void);
+uint32_t duty_cycle_next_sleep_sec(duty_cycle_outcome_t outcome,
+		uint32_t battery_mv);
+void duty_cycle_reset(void);
+
+#if TEST_ON_PC == 0
+void duty_cycle_sleep(duty_cycle_outcome_t outcome);
+#endif
+
+#endif /* DUTY_CYCLE_H_ */
@@ -0,0 +1,239 @@
+/**
+ * @file energy.c
+ * @author yassine hattay
+ * @brief Energy ledger for ESP12/ESP8266.
+ *
+ * The ledger keeps the current power-state flags and the time of the last
+ * change. On every change the interval since then is charged to the
+ * buckets of the states that were active, in uA * ms, before the flags are
+ * updated. Callers run in different tasks, so each update is a short
+ * critical section.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "energy.h"
+#include "../rtc_state/rtc_state.h"
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/** @brief uA * ms in one uAh */
+#define ENERGY_UAMS_PER_UAH 3600000ULL
+
+/** @brief Ledger preserved across deep sleep */
+typedef struct {
+	uint32_t magic;
+	uint32_t wakes;         ///< Boots since power-on
+	uint32_t reports;       ///< Reports accepted by the network since power-on
+	uint32_t deep_sleep_ms; ///< Requested duration of the deep sleep in progress
+	uint64_t charge_uams[ENERGY_BUCKET_COUNT]; ///< Charge per bucket
+} energy_state_t;
+
+RTC_STATE(energy_state_t, s_state, 0x454E5247);
+
+static uint32_t s_flags = 0;
+static int64_t s_last_us = 0;
+static uint64_t s_boot_uams = 0; // Ledger total when this wake started
+
+static const char *const s_bucket_names[ENERGY_BUCKET_COUNT] = { "esp160",
+		"esp80", "light", "deep", "gps", "sim", "sim_tx" };
+
+/**
+ * @brief Charges the interval since the last change to the active states.
+ *
+ * Call with the critical section held.
+ */
+static void energy_accumulate(int64_t now_us) {
+	int64_t dt_us = now_us - s_last_us;
+
+	s_last_us = now_us;
+	if (dt_us <= 0)
+		return;
+
+	energy_bucket_t esp = ENERGY_BUCKET_ESP_SLOW;
+	uint32_t esp_ua = ENERGY_I_ESP_SLOW_UA;
+	if (s_flags & ENERGY_LIGHT_SLEEP) {
+		esp = ENERGY_BUCKET_ESP_LIGHT;
+		esp_ua = ENERGY_I_ESP_LIGHT_UA;
+	} else if (s_flags & ENERGY_CPU_FAST) {
+		esp = ENERGY_BUCKET_ESP_FAST;
+		esp_ua = ENERGY_I_ESP_FAST_UA;
+	}
+	s_state.charge_uams[esp] += (uint64_t) esp_ua * dt_us / 1000;
+
+	if (s_flags & ENERGY_GPS)
+		s_state.charge_uams[ENERGY_BUCKET_GPS] += (uint64_t) ENERGY_I_GPS_UA
+				* dt_us / 1000;
+
+	if (s_flags & ENERGY_MODEM_TX)
+		s_state.charge_uams[ENERGY_BUCKET_SIM_TX] +=
+				(uint64_t) ENERGY_I_SIM_TX_UA * dt_us / 1000;
+	else if (s_flags & ENERGY_SIM)
+		s_state.charge_uams[ENERGY_BUCKET_SIM] += (uint64_t) ENERGY_I_SIM_UA
+				* dt_us / 1000;
+}
+
+/**
+ * @brief Total of all buckets up to now (uA * ms).
+ */
+static uint64_t energy_total_uams(void) {
+	uint64_t total = 0;
+
+	taskENTER_CRITICAL();
+	energy_accumulate(esp_timer_get_time());
+	for (int i = 0; i < ENERGY_BUCKET_COUNT; i++)
+		total += s_state.charge_uams[i];
+	taskEXIT_CRITICAL();
+
+	return total;
+}
+
+/**
+ * @brief Formats a charge in uAh as "m.cc" mAh.
+ */
+static int energy_format_mah(char *out, size_t out_len, uint32_t uah) {
+	return snprintf(out, out_len, "%u.%02u", uah / 1000, (uah % 1000) / 10);
+}
+
+/**
+ * @brief Restores the ledger and charges the deep sleep that just ended.
+ *
+ * Starts a new ledger after a power-on. Time since boot is charged as the
+ * ESP running at its default clock.
+ *
+ * @param timer_wake true if this boot is a deep-sleep timer wake-up.
+ */
+void energy_init(bool timer_wake) {
+	if (!RTC_STATE_CLAIM(s_state) && timer_wake) {
+		s_state.charge_uams[ENERGY_BUCKET_ESP_DEEP] +=
+				(uint64_t) s_state.deep_sleep_ms * ENERGY_I_ESP_DEEP_UA;
+	}
+	s_state.deep_sleep_ms = 0;
+	s_state.wakes++;
+
+	s_flags = CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ >= 160 ? ENERGY_CPU_FAST : 0;
+	s_last_us = 0;
+	s_boot_uams = 0;
+	for (int i = 0; i < ENERGY_BUCKET_COUNT; i++)
+		s_boot_uams += s_state.charge_uams[i];
+}
+
+/**
+ * @brief Records a power-state change.
+ *
+ * Setting a flag that is already set (or clearing a clear one) only
+ * charges the interval so far.
+ *
+ * @param flags One or more `ENERGY_*` state flags.
+ * @param on    true if the states start, false if they end.
+ */
+void energy_set(uint32_t flags, bool on) {
+	taskENTER_CRITICAL();
+	energy_accumulate(esp_timer_get_time());
+	if (on)
+		s_flags |= flags;
+	else
+		s_flags &= ~flags;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Closes the ledger of this wake before deep sleep.
+ *
+ * @param sleep_ms Requested sleep, charged at the next timer wake.
+ */
+void energy_deep_sleep(uint32_t sleep_ms) {
+	taskENTER_CRITICAL();
+	energy_accumulate(esp_timer_get_time());
+	s_flags = 0;
+	s_state.deep_sleep_ms = sleep_ms;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Counts a report accepted by the network.
+ */
+void energy_note_report(void) {
+	s_state.reports++;
+}
+
+/**
+ * @brief Charge drawn since power-on, up to now (uAh).
+ */
+uint32_t energy_total_uah(void) {
+	return (uint32_t) (energy_total_uams() / ENERGY_UAMS_PER_UAH);
+}
+
+/**
+ * @brief Charge drawn since this wake started, up to now (uAh).
+ */
+uint32_t energy_wake_uah(void) {
+	return (uint32_t) ((energy_total_uams() - s_boot_uams)
+			/ ENERGY_UAMS_PER_UAH);
+}
+
+/**
+ * @brief Writes the ledger summary into a buffer.
+ *
+ * One "Energy:" line with the total, wakes, reports and mAh per report,
+ * then one line per bucket with its charge and share of the total.
+ *
+ * @param out     Destination buffer.
+ * @param out_len Size of the destination buffer in bytes.
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t energy_format(char *out, size_t out_len) {
+	uint32_t total = energy_total_uah();
+	uint32_t per_report = s_state.reports ? total / s_state.reports : 0;
+	char total_str[16], report_str[16], bucket_str[16];
+
+	energy_format_mah(total_str, sizeof(total_str), total);
+	energy_format_mah(report_str, sizeof(report_str), per_report);
+	int n = snprintf(out, out_len,
+			"Energy: %s mAh over %u wakes, %u reports, %s mAh/report\n",
+			total_str, s_state.wakes, s_state.reports, report_str);
+	if (n < 0 || (size_t) n >= out_len)
+		return out_len ? out_len - 1 : 0;
+	size_t pos = n;
+
+	for (int i = 0; i < ENERGY_BUCKET_COUNT; i++) {
+		uint32_t uah = (uint32_t) (s_state.charge_uams[i] / ENERGY_UAMS_PER_UAH);
+
+		energy_format_mah(bucket_str, sizeof(bucket_str), uah);
+		n = snprintf(out + pos, out_len - pos, "Energy: %-6s %9s mAh %3u %%\n",
+				s_bucket_names[i], bucket_str,
+				total ? (uint32_t) ((uint64_t) uah * 100 / total) : 0);
+		if (n < 0 || (size_t) n >= out_len - pos)
+			return out_len - 1;
+		pos += n;
+	}
+	return pos;
+}
+
+/**
+ * @brief Writes the one-line summary appended to a report SMS.
+ *
+ * The report being sent is included in the mAh-per-report figure.
+ *
+ * @param out     Destination buffer, `ENERGY_REPORT_STR_SIZE` is enough.
+ * @param out_len Size of the destination buffer in bytes.
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t energy_format_report(char *out, size_t out_len) {
+	uint32_t total = energy_total_uah();
+	char total_str[16], report_str[16];
+
+	energy_format_mah(total_str, sizeof(total_str), total);
+	energy_format_mah(report_str, sizeof(report_str),
+			total / (s_state.reports + 1));
+	int n = snprintf(out, out_len, "Energy: %s mAh, %s/report", total_str,
+			report_str);
+	if (n < 0)
+		return 0;
+	return (size_t) n < out_len ? (size_t) n : (out_len ? out_len - 1 : 0);
+}
@@ -0,0 +1,77 @@
+/**
+ * @file energy.h
+ * @author yassine hattay
+ * @brief Energy ledger for ESP12/ESP8266.
+ *
+ * Every power-state change of the tracker is timestamped here, and the time
+ * spent in each state is charged at a configurable current:
+ * - Power states are flags (`ENERGY_GPS`, `ENERGY_SIM`, `ENERGY_MODEM_TX`,
+ *   `ENERGY_CPU_FAST`, `ENERGY_LIGHT_SLEEP`) switched with `energy_set()`
+ *   next to the code that changes them.
+ * - The charge is accumulated per bucket (ESP at 160 / 80 MHz, light and
+ *   deep sleep, GPS rail, SIM800 idle and transmitting) in RTC memory, so
+ *   the ledger runs from power-on across deep sleeps.
+ * - Deep sleep is charged at the next boot from the requested duration.
+ * - Successful reports are counted, which gives the mAh-per-report figure
+ *   appended to each SMS and shown on the web log page.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef ENERGY_H_
+#define ENERGY_H_
+
+#include "../my_config/my_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Supply current of each power state (uA).
+ *
+ * Estimates, not measured on the board: the ESP, GPS and SIM800 figures
+ * are the former wake-cycle model's 70 / 45 / 80 mA, the 80 MHz current
+ * is a guess scaled from 160 MHz and the sleep and TX currents are
+ * datasheet typicals. Replace them once the board has been measured.
+ */
+#define ENERGY_I_ESP_FAST_UA  70000  ///< CPU active at 160 MHz
+#define ENERGY_I_ESP_SLOW_UA  56000  ///< CPU active at 80 MHz (guess)
+#define ENERGY_I_ESP_LIGHT_UA  1000  ///< Light sleep
+#define ENERGY_I_ESP_DEEP_UA    100  ///< Deep sleep, regulator quiescent included
+#define ENERGY_I_GPS_UA       45000  ///< NEO-6M acquiring / tracking
+#define ENERGY_I_SIM_UA       80000  ///< SIM800L powered: boot, registration, idle
+#define ENERGY_I_SIM_TX_UA   350000  ///< SIM800L transmitting (burst average)
+
+/** @brief Power-state flags */
+#define ENERGY_GPS         (1 << 0) ///< GPS rail on (`GPS_gpio` high)
+#define ENERGY_SIM         (1 << 1) ///< SIM800 rail on (`SIM_gpio` low)
+#define ENERGY_MODEM_TX    (1 << 2) ///< SIM800 transmitting (SMS submit, GPRS)
+#define ENERGY_CPU_FAST    (1 << 3) ///< CPU at 160 MHz, else 80 MHz
+#define ENERGY_LIGHT_SLEEP (1 << 4) ///< ESP in light sleep
+
+/** @brief Buckets of the ledger */
+typedef enum {
+	ENERGY_BUCKET_ESP_FAST = 0,
+	ENERGY_BUCKET_ESP_SLOW,
+	ENERGY_BUCKET_ESP_LIGHT,
+	ENERGY_BUCKET_ESP_DEEP,
+	ENERGY_BUCKET_GPS,
+	ENERGY_BUCKET_SIM,
+	ENERGY_BUCKET_SIM_TX,
+	ENERGY_BUCKET_COUNT
+} energy_bucket_t;
+
+/** @brief Size of a buffer for energy_format_report() */
+#define ENERGY_REPORT_STR_SIZE 48
+
+void energy_init(bool timer_wake);
+void energy_set(uint32_t flags, bool on);
+void energy_deep_sleep(uint32_t sleep_ms);
+void energy_note_report(void);
+uint32_t energy_total_uah(void);
+uint32_t energy_wake_uah(void);
+size_t energy_format(char *out, size_t out_len);
+size_t energy_format_report(char *out, size_t out_len);
+
+#endif /* ENERGY_H_ */
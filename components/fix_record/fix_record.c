@@ -0,0 +1,72 @@
+/**
+ * @file fix_record.c
+ * @author yassine hattay
+ * @brief Shared record of the last GPS fix for ESP12/ESP8266.
+ *
+ * The fix is far too large to update atomically on the 32-bit core (the
+ * old `volatile double` globals could be read half-written), so it is kept
+ * in two buffers:
+ * - Generation N lives in `s_buf[N & 1]`. The single writer fills the other
+ *   buffer and only then advances the generation.
+ * - A reader copies the current buffer and accepts the copy if the
+ *   generation did not move meanwhile. That buffer can only be rewritten
+ *   after the generation has advanced, so an unchanged generation proves the
+ *   copy is whole. A writer stopped halfway is filling the other buffer and
+ *   never makes a reader retry.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "fix_record.h"
+
+/** @brief Both copies of the record, indexed by generation parity */
+static fix_record_t s_buf[2];
+
+/** @brief Generation of the published record (0 = no fix yet) */
+static volatile uint32_t s_generation = 0;
+
+/**
+ * @brief Publishes a new fix. Must only be called from one task (the GPS task).
+ *
+ * @param fix The fix to publish.
+ */
+void fix_record_publish(const fix_record_t *fix) {
+	uint32_t next = s_generation + 1;
+
+	s_buf[next & 1] = *fix;
+	// The record must be complete before readers can see the new generation
+	__sync_synchronize();
+	s_generation = next;
+}
+
+/**
+ * @brief Copies the last published fix.
+ *
+ * @param out Receives the fix (left untouched if there is none yet).
+ * @return Generation of the copied fix, 0 if no fix was published yet.
+ */
+uint32_t fix_record_get(fix_record_t *out) {
+	for (;;) {
+		uint32_t gen = s_generation;
+		if (gen == 0)
+			return 0;
+
+		__sync_synchronize();
+		*out = s_buf[gen & 1];
+		__sync_synchronize();
+
+		if (s_generation == gen)
+			return gen;
+	}
+}
+
+/**
+ * @brief Generation of the last published fix, 0 if none.
+ *
+ * Readers can compare it with the value returned by an earlier
+ * `fix_record_get()` to detect a new fix without copying the record.
+ */
+uint32_t fix_record_generation(void) {
+	return s_generation;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file fix_record.h
+ * @author yassine hattay
+ * @brief Shared record of the last GPS fix for ESP12/ESP8266.
+ *
+ * The GPS task publishes each valid fix as one packed record; any other
+ * task (SIM800, web server) reads a consistent copy of it:
+ * - The record is double-buffered behind a generation counter, so a reader
+ *   never sees half of one fix and half of another.
+ * - Neither side takes a mutex or disables interrupts, and a reader never
+ *   waits for a writer that was preempted mid-update.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef FIX_RECORD_H_
+#define FIX_RECORD_H_
+
+#include "../my_config/my_config.h"
+#include <stdint.h>
+
+/** @brief One GPS fix, as parsed from an RMC sentence */
+typedef struct {
+	int32_t lat_e7;      ///< Latitude in 1e-7 degrees
+	int32_t lon_e7;      ///< Longitude in 1e-7 degrees
+	int32_t speed_cms;   ///< Speed over ground in cm/s, -1 if not reported
+	int32_t course_cdeg; ///< Course over ground in 1/100 degree, -1 if not reported
+	uint64_t utc_ms;     ///< GPS time in ms since the Unix epoch, 0 if not reported
+	uint32_t uptime_ms;  ///< Uptime when the fix was parsed
+	char status;         ///< RMC status ('A' = valid)
+	char mode;           ///< RMC mode indicator (A/D/E/N), 0 if not reported
+} fix_record_t;
+
+void fix_record_publish(const fix_record_t *fix);
+uint32_t fix_record_get(fix_record_t *out);
+uint32_t fix_record_generation(void);
+
+#endif /* FIX_RECORD_H_ */
@@ -0,0 +1,187 @@
+/**
+ * @file geo.c
+ * @author yassine hattay
+ * @brief Fixed-point coordinate helpers for the tracker.
+ *
+ * All functions work on coordinates in 1e-7 degree units and use only
+ * integer arithmetic, which keeps them cheap on the ESP8266 (no FPU) and
+ * lets the same code run in the host-side simulators.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "geo.h"
+#include <stdlib.h>
+
+/** @brief cos(deg) in Q15 for deg = 0..90 */
+static const int16_t cos_q15_table[91] = {
+		32767, 32762, 32747, 32722, 32687, 32642, 32587, 32523,
+		32448, 32364, 32269, 32165, 32051, 31927, 31794, 31650,
+		31498, 31335, 31163, 30982, 30791, 30591, 30381, 30162,
+		29934, 29697, 29451, 29196, 28932, 28659, 28377, 28087,
+		27788, 27481, 27165, 26841, 26509, 26169, 25821, 25465,
+		25101, 24730, 24351, 23964, 23571, 23170, 22762, 22347,
+		21925, 21497, 21062, 20621, 20173, 19720, 19260, 18794,
+		18323, 17846, 17364, 16876, 16384, 15886, 15383, 14876,
+		14364, 13848, 13328, 12803, 12275, 11743, 11207, 10668,
+		10126, 9580, 9032, 8481, 7927, 7371, 6813, 6252,
+		5690, 5126, 4560, 3993, 3425, 2856, 2286, 1715,
+		1144, 572, 0 };
+
+/**
+ * @brief Convert an NMEA coordinate (DDMM.MMMMM / DDDMM.MMMMM) to 1e-7 degrees.
+ *
+ * The integer and fractional parts are parsed separately (up to 5 decimal
+ * places of minutes), so no precision is lost to float conversion.
+ *
+ * @param nmea_coord The NMEA coordinate string (latitude or longitude).
+ * @param hemi Hemisphere character ('N', 'S', 'E', 'W').
+ * @return int32_t Coordinate in 1e-7 degrees, negative for 'S' or 'W'.
+ */
+int32_t geo_nmea_to_e7(const char *nmea_coord, char hemi) {
+	const char *p = nmea_coord;
+	int32_t whole = 0;
+	int32_t frac_e5 = 0;
+	int digits = 0;
+
+	if (!p || !*p)
+		return 0;
+
+	while (*p >= '0' && *p <= '9')
+		whole = whole * 10 + (*p++ - '0');
+	if (*p == '.') {
+		p++;
+		while (*p >= '0' && *p <= '9' && digits < 5) {
+			frac_e5 = frac_e5 * 10 + (*p++ - '0');
+			digits++;
+		}
+	}
+	while (digits++ < 5)
+		frac_e5 *= 10;
+
+	int32_t deg = whole / 100;
+	int32_t min_e5 = (whole % 100) * 100000 + frac_e5;
+
+	// 1e-5 minute = 1e-7 degree * 100/60
+	int32_t e7 = deg * GEO_E7 + (min_e5 * 5 + 1) / 3;
+
+	if (hemi == 'S' || hemi == 'W')
+		e7 = -e7;
+	return e7;
+}
+
+/**
+ * @brief Parse an unsigned NMEA decimal field into a scaled integer.
+ *
+ * For example `geo_parse_decimal("54.73", 2)` returns 5473. Extra decimals
+ * are truncated, missing ones are zero-filled.
+ *
+ * @param str      Decimal string (e.g. speed in knots or course in degrees).
+ * @param decimals Number of decimal places kept in the result.
+ * @return int32_t Scaled value, or -1 if the field is empty.
+ */
+int32_t geo_parse_decimal(const char *str, int decimals) {
+	const char *p = str;
+	int32_t v = 0;
+	int digits = 0;
+
+	if (!p || !*p)
+		return -1;
+
+	while (*p >= '0' && *p <= '9')
+		v = v * 10 + (*p++ - '0');
+	if (*p == '.') {
+		p++;
+		while (*p >= '0' && *p <= '9' && digits < decimals) {
+			v = v * 10 + (*p++ - '0');
+			digits++;
+		}
+	}
+	while (digits++ < decimals)
+		v *= 10;
+	return v;
+}
+
+/**
+ * @brief Signed smallest difference between two courses.
+ *
+ * @param from_cdeg Previous course in 1/100 degree (0..35999).
+ * @param to_cdeg   New course in 1/100 degree (0..35999).
+ * @return int32_t Heading change in 1/100 degree, in -18000..18000.
+ */
+int32_t geo_course_delta_cdeg(int32_t from_cdeg, int32_t to_cdeg) {
+	int32_t d = (to_cdeg - from_cdeg) % 36000;
+	if (d > 18000)
+		d -= 36000;
+	else if (d < -18000)
+		d += 36000;
+	return d;
+}
+
+/**
+ * @brief Cosine of a latitude in Q15, by table lookup and linear interpolation.
+ *
+ * @param lat_e7 Latitude in 1e-7 degrees.
+ * @return int32_t cos(lat) scaled by 32767.
+ */
+int32_t geo_cos_q15(int32_t lat_e7) {
+	uint32_t a = (uint32_t) abs(lat_e7);
+	uint32_t deg = a / GEO_E7;
+	if (deg >= 90)
+		return 0;
+
+	int32_t c0 = cos_q15_table[deg];
+	int32_t c1 = cos_q15_table[deg + 1];
+	uint32_t rem = (a % GEO_E7) / 1000; // 0..9999
+	return c0 - ((c0 - c1) * (int32_t) rem) / 10000;
+}
+
+/**
+ * @brief Integer square root of a 64-bit value.
+ */
+static uint64_t isqrt64(uint64_t v) {
+	uint64_t res = 0;
+	uint64_t bit = 1ULL << 62;
+
+	while (bit > v)
+		bit >>= 2;
+	while (bit) {
+		if (v >= res + bit) {
+			v -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+	return res;
+}
+
+/**
+ * @brief Distance between two points using the equirectangular approximation.
+ *
+ * Projects the longitude difference with cos(mean latitude) and takes the
+ * Euclidean norm. Error stays well below GPS noise for the sub-10 km ranges
+ * used by the movement and geofence checks.
+ *
+ * @return uint32_t Distance in meters (saturated at UINT32_MAX).
+ */
+uint32_t geo_distance_m(int32_t lat1_e7, int32_t lon1_e7, int32_t lat2_e7,
+		int32_t lon2_e7) {
+	int64_t dlat = (int64_t) lat2_e7 - lat1_e7;
+	int64_t dlon = (int64_t) lon2_e7 - lon1_e7;
+
+	// Take the short way around the antimeridian
+	if (dlon > 180 * GEO_E7)
+		dlon -= 360 * GEO_E7;
+	else if (dlon < -180 * GEO_E7)
+		dlon += 360 * GEO_E7;
+
+	int32_t mean_lat = (int32_t) (((int64_t) lat1_e7 + lat2_e7) / 2);
+	int64_t x = (dlon * geo_cos_q15(mean_lat)) >> 15;
+	uint64_t d_e7 = isqrt64((uint64_t) (x * x) + (uint64_t) (dlat * dlat));
+
+	uint64_t m = d_e7 * GEO_M_PER_DEG / GEO_E7;
+	return m > UINT32_MAX ? UINT32_MAX : (uint32_t) m;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file geo.h
+ * @author yassine hattay
+ * @brief Fixed-point coordinate helpers for the tracker.
+ *
+ * Coordinates are handled as signed 32-bit integers in units of 1e-7 degree
+ * (the same resolution the u-blox receivers use internally), so that
+ * parsing and distance checks run without floating point:
+ * - Convert NMEA `DDMM.MMMMM` fields to 1e-7 degrees.
+ * - Compute short distances with an equirectangular approximation.
+ * - Parse NMEA decimal fields (speed, course) into scaled integers.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef GEO_H_
+#define GEO_H_
+
+#include <stdint.h>
+
+/** @brief Fixed-point scale of coordinates (units per degree) */
+#define GEO_E7 10000000L
+
+/** @brief Meters per degree of latitude (WGS-84 mean) */
+#define GEO_M_PER_DEG 111319L
+
+/** @brief Centimeters per second in one hundredth of a knot, scaled by 1e4 */
+#define GEO_CMS_PER_CKNOT_E4 5144
+
+int32_t geo_nmea_to_e7(const char *nmea_coord, char hemi);
+int32_t geo_parse_decimal(const char *str, int decimals);
+int32_t geo_course_delta_cdeg(int32_t from_cdeg, int32_t to_cdeg);
+uint32_t geo_distance_m(int32_t lat1_e7, int32_t lon1_e7, int32_t lat2_e7,
+		int32_t lon2_e7);
+int32_t geo_cos_q15(int32_t lat_e7);
+
+#endif /* GEO_H_ */
@@ -0,0 +1,231 @@
+/**
+ * @file geofence.c
+ * @author yassine hattay
+ * @brief Flash-resident geofence engine for ESP12/ESP8266.
+ *
+ * The table in the `geofence` partition is never loaded into RAM. Each fix
+ * walks the records with `esp_partition_read()`:
+ * 1. Read the 24-byte record header and reject on its bounding box.
+ * 2. Circles: read the center and compare the equirectangular distance.
+ * 3. Polygons: stream the vertices in `GEOFENCE_VERTEX_CHUNK` blocks through
+ *    a fixed-point crossing-number test.
+ *
+ * The resulting inside mask is compared with the mask kept in RTC memory to
+ * produce entry/exit events. The new mask is only stored by
+ * `geofence_commit()` once the events have been reported, so a failed SMS
+ * session reports them again on the next wake.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "geofence.h"
+#include "../geo/geo.h"
+#include "../rtc_state/rtc_state.h"
+#include "esp_partition.h"
+#include <stdio.h>
+#include <string.h>
+
+/** @brief Inside/outside state preserved across deep sleep */
+typedef struct {
+	uint32_t magic;
+	uint16_t count;        ///< Fence count of the table the mask belongs to
+	uint32_t inside_mask;  ///< Bit i set if inside record i
+} geofence_state_t;
+
+RTC_STATE(geofence_state_t, s_state, 0x47465354);
+
+static const esp_partition_t *s_partition = NULL;
+static uint16_t s_count = 0;
+static uint8_t s_ids[GEOFENCE_MAX_FENCES];
+static uint32_t s_pending_mask = 0;
+
+/**
+ * @brief Locates the geofence partition and validates the table header.
+ *
+ * @return `ESP_OK` if a valid table was found, `ESP_ERR_NOT_FOUND` if the
+ * partition is missing, `ESP_ERR_INVALID_VERSION` if it holds no valid table.
+ */
+esp_err_t geofence_init(void) {
+	geofence_header_t header;
+
+	s_count = 0;
+	s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+			ESP_PARTITION_SUBTYPE_ANY, GEOFENCE_PARTITION_LABEL);
+	if (!s_partition) {
+		printf("geofence_init: no '%s' partition\n", GEOFENCE_PARTITION_LABEL);
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	esp_err_t ret = esp_partition_read(s_partition, 0, &header,
+			sizeof(header));
+	if (ret != ESP_OK)
+		return ret;
+
+	if (header.magic != GEOFENCE_MAGIC || header.version != GEOFENCE_VERSION) {
+		printf("geofence_init: no valid table (magic 0x%08X)\n", header.magic);
+		return ESP_ERR_INVALID_VERSION;
+	}
+
+	s_count = header.count;
+	if (s_count > GEOFENCE_MAX_FENCES) {
+		printf("geofence_init: %u fences, only the first %d are tracked\n",
+				s_count, GEOFENCE_MAX_FENCES);
+		s_count = GEOFENCE_MAX_FENCES;
+	}
+
+	// A different table invalidates the stored inside mask
+	if (RTC_STATE_CLAIM(s_state) || s_state.count != s_count) {
+		s_state.count = s_count;
+		s_state.inside_mask = 0;
+	}
+
+	printf("geofence_init: %u fences loaded\n", s_count);
+	return ESP_OK;
+}
+
+/**
+ * @brief Returns true if a geofence table with at least one fence is loaded.
+ */
+bool geofence_active(void) {
+	return s_count > 0;
+}
+
+/**
+ * @brief Crossing-number point-in-polygon test streamed from flash.
+ *
+ * For every edge crossing the point's latitude, the crossing longitude is
+ * compared without division: lon < x0 + (x1 - x0) * (lat - y0) / (y1 - y0)
+ * is evaluated as a 64-bit cross-multiplication, sign-corrected for the
+ * edge direction.
+ *
+ * @param offset Partition offset of the first vertex.
+ * @param n      Number of vertices.
+ * @return true if the point lies inside the polygon.
+ */
+static bool point_in_polygon(uint32_t offset, uint16_t n, int32_t lat_e7,
+		int32_t lon_e7) {
+	geofence_vertex_t chunk[GEOFENCE_VERTEX_CHUNK];
+	geofence_vertex_t prev;
+	bool inside = false;
+
+	if (n < 3)
+		return false;
+
+	// The closing edge runs from the last vertex back to the first
+	if (esp_partition_read(s_partition,
+			offset + (n - 1) * sizeof(geofence_vertex_t), &prev, sizeof(prev))
+			!= ESP_OK)
+		return false;
+
+	for (uint16_t i = 0; i < n;) {
+		uint16_t chunk_n = n - i;
+		if (chunk_n > GEOFENCE_VERTEX_CHUNK)
+			chunk_n = GEOFENCE_VERTEX_CHUNK;
+
+		if (esp_partition_read(s_partition,
+				offset + i * sizeof(geofence_vertex_t), chunk,
+				chunk_n * sizeof(geofence_vertex_t)) != ESP_OK)
+			return false;
+
+		for (uint16_t k = 0; k < chunk_n; k++) {
+			const geofence_vertex_t *cur = &chunk[k];
+
+			if ((cur->lat_e7 > lat_e7) != (prev.lat_e7 > lat_e7)) {
+				int64_t dy = (int64_t) prev.lat_e7 - cur->lat_e7;
+				int64_t lhs = ((int64_t) lon_e7 - cur->lon_e7) * dy;
+				int64_t rhs = ((int64_t) prev.lon_e7 - cur->lon_e7)
+						* ((int64_t) lat_e7 - cur->lat_e7);
+				if (dy > 0 ? lhs < rhs : lhs > rhs)
+					inside = !inside;
+			}
+			prev = *cur;
+		}
+		i += chunk_n;
+	}
+	return inside;
+}
+
+/**
+ * @brief Evaluates a position against every fence in the table.
+ *
+ * @param lat_e7 Latitude in 1e-7 degrees.
+ * @param lon_e7 Longitude in 1e-7 degrees.
+ * @return Bit mask with bit i set if the position is inside record i.
+ */
+uint32_t geofence_evaluate(int32_t lat_e7, int32_t lon_e7) {
+	uint32_t mask = 0;
+	uint32_t offset = sizeof(geofence_header_t);
+
+	for (uint16_t i = 0; i < s_count; i++) {
+		geofence_record_t rec;
+		if (esp_partition_read(s_partition, offset, &rec, sizeof(rec))
+				!= ESP_OK)
+			break;
+
+		uint32_t vertices = offset + sizeof(rec);
+		offset = vertices + rec.n_vertices * sizeof(geofence_vertex_t);
+		s_ids[i] = rec.id;
+
+		// Bounding-box pre-rejection, no vertex is read for far fences
+		if (lat_e7 < rec.min_lat_e7 || lat_e7 > rec.max_lat_e7
+				|| lon_e7 < rec.min_lon_e7 || lon_e7 > rec.max_lon_e7)
+			continue;
+
+		bool inside = false;
+		if (rec.type == GEOFENCE_CIRCLE && rec.n_vertices >= 1) {
+			geofence_vertex_t center;
+			if (esp_partition_read(s_partition, vertices, &center,
+					sizeof(center)) == ESP_OK)
+				inside = geo_distance_m(center.lat_e7, center.lon_e7, lat_e7,
+						lon_e7) <= rec.radius_m;
+		} else if (rec.type == GEOFENCE_POLYGON) {
+			inside = point_in_polygon(vertices, rec.n_vertices, lat_e7, lon_e7);
+		}
+
+		if (inside)
+			mask |= 1UL << i;
+	}
+	return mask;
+}
+
+/**
+ * @brief Evaluates a fix and lists the fences entered or exited since the
+ * last committed state.
+ *
+ * @param lat_e7      Latitude in 1e-7 degrees.
+ * @param lon_e7      Longitude in 1e-7 degrees.
+ * @param events      Output array for the events (may be NULL if max_events is 0).
+ * @param max_events  Capacity of the events array.
+ * @return Number of events (may exceed max_events; only max_events are written).
+ */
+int geofence_update(int32_t lat_e7, int32_t lon_e7, geofence_event_t *events,
+		int max_events) {
+	if (!geofence_active())
+		return 0;
+
+	s_pending_mask = geofence_evaluate(lat_e7, lon_e7);
+	uint32_t changed = s_pending_mask ^ s_state.inside_mask;
+
+	int n = 0;
+	for (uint16_t i = 0; i < s_count; i++) {
+		if (!(changed & (1UL << i)))
+			continue;
+		if (n < max_events) {
+			events[n].id = s_ids[i];
+			events[n].entered = (s_pending_mask >> i) & 1;
+		}
+		n++;
+	}
+	return n;
+}
+
+/**
+ * @brief Stores the mask of the last geofence_update() in RTC memory.
+ *
+ * Call once the entry/exit events have been reported.
+ */
+void geofence_commit(void) {
+	if (geofence_active())
+		s_state.inside_mask = s_pending_mask;
+}
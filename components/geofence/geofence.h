@@ -0,0 +1,89 @@
+/**
+ * @file geofence.h
+ * @author yassine hattay
+ * @brief Flash-resident geofence engine for ESP12/ESP8266.
+ *
+ * Geofences (circles and polygons) are stored as a compact binary table in
+ * the `geofence` data partition and evaluated record by record straight from
+ * flash, so RAM use does not depend on the number of fences:
+ * - Bounding-box pre-rejection before any vertex is read.
+ * - Fixed-point (1e-7 degree) point-in-polygon and circle tests.
+ * - Inside/outside state kept in RTC memory to turn fixes into entry/exit
+ *   events.
+ *
+ * The table is generated and flashed with `host_geofence.py`.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef GEOFENCE_H_
+#define GEOFENCE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/** @brief Label of the data partition holding the geofence table */
+#define GEOFENCE_PARTITION_LABEL "geofence"
+
+/** @brief Table magic, "GFNC" little-endian */
+#define GEOFENCE_MAGIC 0x434E4647
+
+/** @brief Table format version */
+#define GEOFENCE_VERSION 1
+
+/** @brief Maximum number of fences tracked for entry/exit (bits of the RTC mask) */
+#define GEOFENCE_MAX_FENCES 32
+
+/** @brief Vertices read from flash per chunk during the polygon test */
+#define GEOFENCE_VERTEX_CHUNK 16
+
+/** @brief When fences are loaded, only entry/exit events (or heartbeats) are reported */
+#define GEOFENCE_REPORT_ONLY_EVENTS 1
+
+/** @brief Fence shapes stored in the table */
+typedef enum {
+	GEOFENCE_CIRCLE = 1,   ///< One vertex (center) plus radius_m
+	GEOFENCE_POLYGON = 2,  ///< n_vertices vertices, implicitly closed
+} geofence_type_t;
+
+/** @brief Table header at offset 0 of the partition */
+typedef struct {
+	uint32_t magic;        ///< GEOFENCE_MAGIC
+	uint16_t version;      ///< GEOFENCE_VERSION
+	uint16_t count;        ///< Number of fence records that follow
+} geofence_header_t;
+
+/** @brief Fence record header, followed by n_vertices geofence_vertex_t */
+typedef struct {
+	uint8_t type;          ///< geofence_type_t
+	uint8_t id;            ///< User-visible fence ID reported in events
+	uint16_t n_vertices;   ///< Vertices following this header
+	uint32_t radius_m;     ///< Circle radius (meters), 0 for polygons
+	int32_t min_lat_e7;    ///< Bounding box, 1e-7 degrees
+	int32_t min_lon_e7;
+	int32_t max_lat_e7;
+	int32_t max_lon_e7;
+} geofence_record_t;
+
+/** @brief One polygon vertex or circle center */
+typedef struct {
+	int32_t lat_e7;
+	int32_t lon_e7;
+} geofence_vertex_t;
+
+/** @brief Entry/exit event produced by geofence_update() */
+typedef struct {
+	uint8_t id;            ///< Fence ID from the table
+	bool entered;          ///< true on entry, false on exit
+} geofence_event_t;
+
+esp_err_t geofence_init(void);
+bool geofence_active(void);
+uint32_t geofence_evaluate(int32_t lat_e7, int32_t lon_e7);
+int geofence_update(int32_t lat_e7, int32_t lon_e7, geofence_event_t *events,
+		int max_events);
+void geofence_commit(void);
+
+#endif /* GEOFENCE_H_ */
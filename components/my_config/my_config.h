@@ -1,6 +1,9 @@
 #ifndef MY_CONFIG_H  // Check if not defined
 #define MY_CONFIG_H  // Define it to prevent multiple inclusions
 
+// Host builds (host_*.py tools) pass -DTEST_ON_PC=1 on the command line
+#ifndef TEST_ON_PC
 #define TEST_ON_PC 0
+#endif
 
 #endif // MY_CONFIG_H
@@ -0,0 +1,154 @@
+/**
+ * @file power.c
+ * @author yassine hattay
+ * @brief CPU clock and light-sleep control for ESP12/ESP8266.
+ *
+ * The UART keeps its clock source through a clock switch (it runs from the
+ * 80 MHz APB clock), so changing the CPU clock never disturbs the GPS or
+ * SIM800 links. Light sleep stops the CPU and the RTOS tick; the SDK
+ * restores the tick count on wake-up, so `vTaskDelay()` and timeouts keep
+ * their meaning across a nap.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "power.h"
+#include <stdio.h>
+#include "sdkconfig.h"
+#include "esp_system.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "../energy/energy.h"
+
+static uint32_t s_cpu_mhz = CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ;
+static power_stats_t s_stats;
+
+/**
+ * @brief Switches the CPU clock.
+ *
+ * @param mhz `POWER_CPU_MHZ_FAST` or `POWER_CPU_MHZ_SLOW`, other values
+ *            select the nearest of the two.
+ */
+void power_set_cpu_mhz(uint32_t mhz) {
+	mhz = mhz >= POWER_CPU_MHZ_FAST ? POWER_CPU_MHZ_FAST : POWER_CPU_MHZ_SLOW;
+	if (mhz == s_cpu_mhz)
+		return;
+
+	esp_err_t err = esp_set_cpu_freq(
+			mhz == POWER_CPU_MHZ_FAST ? ESP_CPU_FREQ_160M : ESP_CPU_FREQ_80M);
+	if (err != ESP_OK) {
+		printf("power_set_cpu_mhz: switch to %u MHz failed, error: %d\n", mhz,
+				err);
+		return;
+	}
+	s_cpu_mhz = mhz;
+	energy_set(ENERGY_CPU_FAST, mhz == POWER_CPU_MHZ_FAST);
+}
+
+/**
+ * @brief Current CPU clock in MHz. In IRAM, the soft UART interrupts scale
+ * CCOUNT deadlines with it.
+ */
+IRAM_ATTR uint32_t power_cpu_mhz(void) {
+	return s_cpu_mhz;
+}
+
+/**
+ * @brief Prepares a task to nap between the bursts of a UART stream.
+ *
+ * @param nap       State to initialize.
+ * @param link      Transport the stream is read from (flushed before a nap).
+ * @param rx_pin    RX pin of that UART.
+ * @param baud      Line speed, 10 bits per character.
+ * @param period_ms Expected period of the bursts.
+ */
+void power_rx_nap_init(power_rx_nap_t *nap, transport_t *link,
+		gpio_num_t rx_pin, uint32_t baud, uint32_t period_ms) {
+	nap->link = link;
+	nap->rx_pin = rx_pin;
+	nap->char_us = 10000000UL / baud;
+	nap->period_ms = period_ms;
+	nap->burst_us = 0;
+	nap->idle = true;
+}
+
+/**
+ * @brief Reports a successful read of `len` bytes.
+ *
+ * The first read after an idle gap starts a burst; its start is dated back
+ * by the time the bytes took on the line and anchors the next prediction.
+ */
+void power_rx_nap_data(power_rx_nap_t *nap, size_t len) {
+	if (len == 0)
+		return;
+
+	if (nap->idle)
+		nap->burst_us = esp_timer_get_time() - (int64_t) len * nap->char_us;
+	nap->idle = false;
+}
+
+/**
+ * @brief Reports an empty read and naps until the next burst if worthwhile.
+ *
+ * Does nothing until a first burst was seen, or when the next burst is due
+ * within `POWER_NAP_MIN_MS` + `POWER_NAP_GUARD_MS`. Otherwise the link
+ * (UART0 also carries the console) is flushed and the chip enters light sleep, woken by a timer just before
+ * the predicted burst or by a start bit on the RX pin. The first bytes of
+ * a burst that wakes the chip through the RX pin are lost, and that burst
+ * re-anchors the prediction.
+ *
+ * @return true if the task napped.
+ */
+bool power_rx_nap_idle(power_rx_nap_t *nap) {
+	nap->idle = true;
+	if (nap->burst_us == 0)
+		return false;
+
+	int64_t period_us = (int64_t) nap->period_ms * 1000;
+	int64_t guard_us = POWER_NAP_GUARD_MS * 1000;
+	int64_t now = esp_timer_get_time();
+	int64_t next = nap->burst_us + period_us;
+
+	// Bursts missed while awake (receiver silent): aim at the next slot
+	if (next <= now + guard_us)
+		next += ((now + guard_us - next) / period_us + 1) * period_us;
+
+	int64_t nap_us = next - guard_us - now;
+	if (nap_us < POWER_NAP_MIN_MS * 1000)
+		return false;
+
+	transport_flush(nap->link, POWER_TX_DRAIN_MS);
+	gpio_wakeup_enable(nap->rx_pin, GPIO_INTR_LOW_LEVEL);
+	esp_sleep_enable_gpio_wakeup();
+	esp_sleep_enable_timer_wakeup((uint32_t) nap_us);
+
+	energy_set(ENERGY_LIGHT_SLEEP, true);
+	esp_err_t err = esp_light_sleep_start();
+	energy_set(ENERGY_LIGHT_SLEEP, false);
+	gpio_wakeup_disable(nap->rx_pin);
+	if (err != ESP_OK) {
+		printf("power_rx_nap_idle: light sleep failed, error: %d\n", err);
+		return false;
+	}
+
+	int64_t woke = esp_timer_get_time();
+	s_stats.sleep_ms += (uint32_t) ((woke - now) / 1000);
+	s_stats.naps++;
+	if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+		s_stats.rx_wakes++;
+		nap->burst_us = woke;
+		nap->idle = false;
+	} else {
+		s_stats.timer_wakes++;
+	}
+	return true;
+}
+
+/**
+ * @brief Copies the light-sleep statistics of this wake cycle.
+ */
+void power_get_stats(power_stats_t *out) {
+	*out = s_stats;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file power.h
+ * @author yassine hattay
+ * @brief CPU clock and light-sleep control for ESP12/ESP8266.
+ *
+ * This module lowers the ESP-side current while the firmware mostly waits:
+ * - The CPU clock is switched between 80 and 160 MHz per wake-cycle phase.
+ * - A task reading a periodic UART stream (the NEO-6M sends one NMEA burst
+ *   per second) naps in light sleep between bursts. The tick stops while
+ *   asleep, and the nap ends on a timer set just before the next predicted
+ *   burst, or on the RX line going low if the prediction is off.
+ * - Time spent asleep is counted so the wake cycle and the host power model
+ *   (`host_power_model.py`) can report the saving.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include "../my_config/my_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "../transport/transport.h"
+
+/** @brief CPU clock for computing phases (MHz) */
+#define POWER_CPU_MHZ_FAST 160
+
+/** @brief CPU clock for phases waiting on peripherals (MHz) */
+#define POWER_CPU_MHZ_SLOW 80
+
+/** @brief A read returning nothing for this long means the line is idle (ms) */
+#define POWER_RX_IDLE_MS 20
+
+/** @brief Naps shorter than this cost more to enter than they save (ms) */
+#define POWER_NAP_MIN_MS 30
+
+/** @brief The nap ends this long before the predicted burst (ms) */
+#define POWER_NAP_GUARD_MS 30
+
+/** @brief Longest wait for the link to drain before a nap (ms) */
+#define POWER_TX_DRAIN_MS 200
+
+/** @brief Light-sleep statistics of the current wake cycle */
+typedef struct {
+	uint32_t sleep_ms;    ///< Total time in light sleep
+	uint32_t naps;        ///< Number of naps
+	uint32_t rx_wakes;    ///< Naps ended by RX activity
+	uint32_t timer_wakes; ///< Naps ended by the burst timer
+} power_stats_t;
+
+/** @brief State of a task napping between bursts of a UART stream */
+typedef struct {
+	transport_t *link;  ///< Link of the stream, flushed before sleeping
+	gpio_num_t rx_pin;  ///< RX pin, wakes the chip on a start bit
+	uint32_t char_us;   ///< Time of one character on the line
+	uint32_t period_ms; ///< Expected period of the bursts
+	int64_t burst_us;   ///< Start of the last burst, 0 if not seen yet
+	bool idle;          ///< The last read returned nothing
+} power_rx_nap_t;
+
+void power_set_cpu_mhz(uint32_t mhz);
+uint32_t power_cpu_mhz(void);
+
+void power_rx_nap_init(power_rx_nap_t *nap, transport_t *link,
+		gpio_num_t rx_pin, uint32_t baud, uint32_t period_ms);
+void power_rx_nap_data(power_rx_nap_t *nap, size_t len);
+bool power_rx_nap_idle(power_rx_nap_t *nap);
+
+void power_get_stats(power_stats_t *out);
+
+#endif /* POWER_H_ */
@@ -0,0 +1,100 @@
+/**
+ * @file report_filter.c
+ * @author yassine hattay
+ * @brief Movement-threshold suppression of redundant position reports.
+ *
+ * The last reported position and the time elapsed since that report are
+ * kept in RTC memory. A fix is only reported if it lies outside
+ * `REPORT_RADIUS_M` (fixed-point equirectangular distance) or the heartbeat
+ * interval has run out, so the SIM800L stays off while the vehicle is parked.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "report_filter.h"
+#include "../geo/geo.h"
+#include "../rtc_state/rtc_state.h"
+#include <stdio.h>
+#include <string.h>
+
+/** @brief Report state preserved across deep sleep */
+typedef struct {
+	uint32_t magic;
+	int32_t lat_e7;            ///< Last reported latitude (1e-7 deg)
+	int32_t lon_e7;            ///< Last reported longitude (1e-7 deg)
+	uint32_t since_report_sec; ///< Time elapsed since that report
+	uint8_t has_report;        ///< 1 once a report has been sent
+} report_filter_state_t;
+
+RTC_STATE(report_filter_state_t, s_state, 0x52505446);
+
+/**
+ * @brief Decides whether a new fix should be reported.
+ *
+ * @param lat_e7 Latitude of the new fix in 1e-7 degrees.
+ * @param lon_e7 Longitude of the new fix in 1e-7 degrees.
+ * @return true if the fix moved beyond the radius, nothing was reported yet
+ *         or the heartbeat is due; false if the report can be suppressed.
+ */
+bool report_filter_should_send(int32_t lat_e7, int32_t lon_e7) {
+	if (report_filter_heartbeat_due())
+		return true;
+
+	uint32_t d = geo_distance_m(s_state.lat_e7, s_state.lon_e7, lat_e7, lon_e7);
+	if (d > REPORT_RADIUS_M)
+		return true;
+
+#if TEST_ON_PC == 0
+	printf("Report suppressed: %u m from last report, %u s ago\n", d,
+			s_state.since_report_sec);
+#endif
+	return false;
+}
+
+/**
+ * @brief Returns true if nothing was reported yet or the heartbeat is due.
+ */
+bool report_filter_heartbeat_due(void) {
+	RTC_STATE_CLAIM(s_state);
+
+	return !s_state.has_report
+			|| s_state.since_report_sec >= REPORT_HEARTBEAT_SEC;
+}
+
+/**
+ * @brief Records a position that was successfully reported.
+ *
+ * @param lat_e7 Reported latitude in 1e-7 degrees.
+ * @param lon_e7 Reported longitude in 1e-7 degrees.
+ */
+void report_filter_mark_sent(int32_t lat_e7, int32_t lon_e7) {
+	RTC_STATE_CLAIM(s_state);
+
+	s_state.lat_e7 = lat_e7;
+	s_state.lon_e7 = lon_e7;
+	s_state.since_report_sec = 0;
+	s_state.has_report = 1;
+}
+
+/**
+ * @brief Advances the heartbeat timer (awake time plus upcoming sleep).
+ *
+ * @param sec Seconds to add.
+ */
+void report_filter_note_elapsed(uint32_t sec) {
+	RTC_STATE_CLAIM(s_state);
+
+	if (s_state.since_report_sec > UINT32_MAX - sec)
+		s_state.since_report_sec = UINT32_MAX;
+	else
+		s_state.since_report_sec += sec;
+}
+
+/**
+ * @brief Forgets the last reported position.
+ */
+void report_filter_reset(void) {
+	RTC_STATE_FORGET(s_state);
+	RTC_STATE_CLAIM(s_state);
+}
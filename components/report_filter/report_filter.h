@@ -0,0 +1,34 @@
+/**
+ * @file report_filter.h
+ * @author yassine hattay
+ * @brief Movement-threshold suppression of redundant position reports.
+ *
+ * This module decides whether a new fix is worth an SMS:
+ * - Compares the fix against the last reported position kept in RTC memory.
+ * - Suppresses reports within `REPORT_RADIUS_M` of it.
+ * - Forces a heartbeat report every `REPORT_HEARTBEAT_SEC` regardless.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef REPORT_FILTER_H_
+#define REPORT_FILTER_H_
+
+#include "../my_config/my_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** @brief Fixes closer than this to the last report are suppressed (meters) */
+#define REPORT_RADIUS_M 100
+
+/** @brief Maximum time without a report while parked (seconds) */
+#define REPORT_HEARTBEAT_SEC (6 * 3600)
+
+bool report_filter_should_send(int32_t lat_e7, int32_t lon_e7);
+bool report_filter_heartbeat_due(void);
+void report_filter_mark_sent(int32_t lat_e7, int32_t lon_e7);
+void report_filter_note_elapsed(uint32_t sec);
+void report_filter_reset(void);
+
+#endif /* REPORT_FILTER_H_ */
@@ -0,0 +1,127 @@
+/**
+ * @file ring_buffer.c
+ * @author yassine hattay
+ * @brief Lock-free single-producer / single-consumer byte ring for ESP12/ESP8266.
+ *
+ * The ESP8266 has a single core, so the barriers only have to stop the
+ * compiler from moving a data access across the counter update that
+ * publishes it; an interrupt then always sees either the old or the new
+ * counter with the matching data.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "ring_buffer.h"
+#include <string.h>
+
+#if TEST_ON_PC == 0
+#include "esp_attr.h"
+#else
+#define IRAM_ATTR
+#endif
+
+/**
+ * @brief Sets up a ring over caller-provided storage.
+ *
+ * @param rb      Ring to initialize.
+ * @param storage Buffer of `size` bytes.
+ * @param size    Capacity, must be a power of two.
+ * @return false if `size` is not a power of two.
+ */
+bool ring_buffer_init(ring_buffer_t *rb, uint8_t *storage, uint32_t size) {
+	if (size == 0 || (size & (size - 1)) != 0)
+		return false;
+
+	rb->buf = storage;
+	rb->mask = size - 1;
+	rb->head = 0;
+	rb->tail = 0;
+	rb->overruns = 0;
+	rb->peak = 0;
+	return true;
+}
+
+/**
+ * @brief Appends one byte. Producer side, safe in an ISR.
+ *
+ * @return false if the ring was full and the byte was dropped.
+ */
+IRAM_ATTR bool ring_buffer_push(ring_buffer_t *rb, uint8_t byte) {
+	uint32_t head = rb->head;
+	uint32_t used = head - rb->tail;
+
+	if (used > rb->mask) {
+		rb->overruns++;
+		return false;
+	}
+
+	rb->buf[head & rb->mask] = byte;
+	__sync_synchronize(); // data before the new head
+	rb->head = head + 1;
+
+	if (used + 1 > rb->peak)
+		rb->peak = used + 1;
+	return true;
+}
+
+/**
+ * @brief Number of bytes waiting to be consumed.
+ */
+IRAM_ATTR uint32_t ring_buffer_count(const ring_buffer_t *rb) {
+	return rb->head - rb->tail;
+}
+
+/**
+ * @brief Gives the longest contiguous run of waiting bytes, in place.
+ *
+ * Bytes that wrap around the end of the storage come in a second span
+ * after `ring_buffer_consume()`. Consumer side.
+ *
+ * @param rb   Ring to read.
+ * @param span Set to the first waiting byte.
+ * @return Length of the span, 0 if the ring is empty.
+ */
+IRAM_ATTR size_t ring_buffer_peek(const ring_buffer_t *rb,
+		const uint8_t **span) {
+	uint32_t tail = rb->tail;
+	uint32_t used = rb->head - tail;
+	__sync_synchronize(); // head before the data it covers
+
+	uint32_t start = tail & rb->mask;
+	uint32_t to_end = rb->mask + 1 - start;
+
+	*span = rb->buf + start;
+	return used < to_end ? used : to_end;
+}
+
+/**
+ * @brief Releases `len` bytes read through `ring_buffer_peek()`.
+ */
+IRAM_ATTR void ring_buffer_consume(ring_buffer_t *rb, size_t len) {
+	__sync_synchronize(); // data read before the slots are released
+	rb->tail += len;
+}
+
+/**
+ * @brief Copies and consumes up to `max_len` bytes. Consumer side, safe in
+ * an ISR.
+ *
+ * @return Number of bytes copied.
+ */
+IRAM_ATTR size_t ring_buffer_pop(ring_buffer_t *rb, uint8_t *out,
+		size_t max_len) {
+	size_t total = 0;
+	const uint8_t *span;
+	size_t len;
+
+	// At most two spans: up to the end of the storage, then from its start
+	while (total < max_len && (len = ring_buffer_peek(rb, &span)) > 0) {
+		if (len > max_len - total)
+			len = max_len - total;
+		memcpy(out + total, span, len);
+		ring_buffer_consume(rb, len);
+		total += len;
+	}
+	return total;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file ring_buffer.h
+ * @author yassine hattay
+ * @brief Lock-free single-producer / single-consumer byte ring for ESP12/ESP8266.
+ *
+ * One producer pushes bytes and one consumer takes them out, without locks
+ * or disabled interrupts. Either side may be an ISR (all functions live in
+ * IRAM): the soft UART receiver pushes from its timer interrupt, the soft
+ * UART transmitter pops from it.
+ * - The size is a power of two, so head and tail are free-running counters
+ *   and indexing is a mask.
+ * - Only the producer writes `head` and only the consumer writes `tail`; a
+ *   barrier orders each data access against the counter update.
+ * - The consumer reads in place through contiguous spans
+ *   (`ring_buffer_peek()` then `ring_buffer_consume()`), or copies a batch
+ *   with `ring_buffer_pop()`.
+ * - Bytes pushed into a full ring are dropped and counted as overruns.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef RING_BUFFER_H_
+#define RING_BUFFER_H_
+
+#include "../my_config/my_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Ring state, storage is provided by the caller */
+typedef struct {
+	uint8_t *buf;
+	uint32_t mask;              ///< Size - 1
+	volatile uint32_t head;     ///< Bytes pushed, written by the producer only
+	volatile uint32_t tail;     ///< Bytes consumed, written by the consumer only
+	volatile uint32_t overruns; ///< Bytes dropped because the ring was full
+	volatile uint32_t peak;     ///< Highest fill level seen by the producer
+} ring_buffer_t;
+
+bool ring_buffer_init(ring_buffer_t *rb, uint8_t *storage, uint32_t size);
+bool ring_buffer_push(ring_buffer_t *rb, uint8_t byte);
+uint32_t ring_buffer_count(const ring_buffer_t *rb);
+size_t ring_buffer_peek(const ring_buffer_t *rb, const uint8_t **span);
+void ring_buffer_consume(ring_buffer_t *rb, size_t len);
+size_t ring_buffer_pop(ring_buffer_t *rb, uint8_t *out, size_t max_len);
+
+#endif /* RING_BUFFER_H_ */
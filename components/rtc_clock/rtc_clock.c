@@ -0,0 +1,279 @@
+/**
+ * @file rtc_clock.c
+ * @author yassine hattay
+ * @brief UTC timekeeping across deep sleep for ESP12/ESP8266.
+ *
+ * The ESP8266 loses its system time in deep sleep, so the clock is kept as
+ * "UTC at boot" plus uptime:
+ * 1. `rtc_clock_prepare_sleep()` stores the current UTC and the requested
+ *    sleep duration in RTC memory.
+ * 2. `rtc_clock_init()` on a timer wake predicts the UTC of this boot as
+ *    sleep start + requested duration * (1 + drift).
+ * 3. `rtc_clock_sync()` with GPS time measures how far that prediction was
+ *    off, updates the drift coefficient with a first-order filter and resets
+ *    the clock to GPS time.
+ * 4. `rtc_clock_schedule_ms()` turns a nominal sleep into the timer request
+ *    that wakes on the nearest round wall-clock boundary once the drift is
+ *    applied, so reports stay on schedule instead of wandering.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "rtc_clock.h"
+#include "../rtc_state/rtc_state.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if TEST_ON_PC == 0
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+/** @brief Clock state preserved across deep sleep */
+typedef struct {
+	uint32_t magic;
+	uint8_t valid;               ///< 1 once GPS time has been seen since power-on
+	uint64_t boot_utc_ms;        ///< Estimated UTC at uptime 0 of this boot
+	uint64_t sleep_start_utc_ms; ///< UTC when the last deep sleep started
+	uint32_t sleep_req_ms;       ///< Requested duration of that sleep
+	uint32_t cal_sleep_ms;       ///< Sleep before this boot if long enough to measure drift, else 0
+	int32_t drift_ppm;           ///< Measured (actual / requested - 1) of timed sleeps
+} rtc_clock_state_t;
+
+RTC_STATE(rtc_clock_state_t, s_state, 0x52544343);
+
+#if TEST_ON_PC == 0
+/**
+ * @brief Milliseconds since boot from the FreeRTOS tick count.
+ */
+static uint64_t rtc_clock_uptime_ms(void) {
+	return (uint64_t) xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+#else
+static uint64_t s_host_uptime_ms = 0;
+
+static uint64_t rtc_clock_uptime_ms(void) {
+	return s_host_uptime_ms;
+}
+
+/**
+ * @brief Host builds: sets the uptime returned to the clock.
+ */
+void rtc_clock_host_set_uptime_ms(uint64_t uptime_ms) {
+	s_host_uptime_ms = uptime_ms;
+}
+
+/**
+ * @brief Host builds: simulates a power-on (RTC memory lost).
+ */
+void rtc_clock_reset(void) {
+	RTC_STATE_FORGET(s_state);
+}
+#endif
+
+/** @brief Wall-clock periods wake-ups are aligned to, largest first (s) */
+static const uint32_t s_align_sec[] = { 3600, 1800, 900, 600, 300, 60 };
+
+/**
+ * @brief Sleep duration corrected by the measured drift coefficient.
+ */
+static uint64_t rtc_clock_corrected_ms(uint32_t req_ms) {
+	return (uint64_t) ((int64_t) req_ms
+			+ (int64_t) req_ms * s_state.drift_ppm / 1000000);
+}
+
+/**
+ * @brief Restores the clock at boot.
+ *
+ * After a timed deep-sleep wake the UTC of this boot is predicted from the
+ * stored sleep start and the drift-corrected sleep duration. Any other reset
+ * (power-on, reset button) invalidates the time but keeps the drift
+ * coefficient as long as RTC memory survived.
+ *
+ * @param timer_wake true if this boot is a wake from a timed deep sleep.
+ */
+void rtc_clock_init(bool timer_wake) {
+	RTC_STATE_CLAIM(s_state);
+
+	s_state.cal_sleep_ms = 0;
+	if (timer_wake && s_state.valid && s_state.sleep_req_ms > 0) {
+		s_state.boot_utc_ms = s_state.sleep_start_utc_ms
+				+ rtc_clock_corrected_ms(s_state.sleep_req_ms);
+		if (s_state.sleep_req_ms >= RTC_CLOCK_MIN_CAL_SLEEP_MS)
+			s_state.cal_sleep_ms = s_state.sleep_req_ms;
+	} else {
+		s_state.valid = 0;
+	}
+	s_state.sleep_req_ms = 0;
+}
+
+/**
+ * @brief Returns true if the clock holds a GPS-derived time.
+ */
+bool rtc_clock_valid(void) {
+	return RTC_STATE_VALID(s_state) && s_state.valid;
+}
+
+/**
+ * @brief Current UTC in milliseconds since the Unix epoch (0 if unknown).
+ */
+uint64_t rtc_clock_now_ms(void) {
+	if (!rtc_clock_valid())
+		return 0;
+	return s_state.boot_utc_ms + rtc_clock_uptime_ms();
+}
+
+/**
+ * @brief Sets the clock from GPS time and updates the drift estimate.
+ *
+ * The first sync after a calibrating wake compares the predicted time with
+ * GPS time. The error, divided by the requested sleep, is the drift not yet
+ * covered by the coefficient, which moves toward it by 1 / 2^
+ * `RTC_CLOCK_DRIFT_SHIFT`.
+ *
+ * @param utc_ms GPS time in milliseconds since the Unix epoch.
+ */
+void rtc_clock_sync(uint64_t utc_ms) {
+	if (utc_ms == 0)
+		return;
+
+	uint64_t uptime = rtc_clock_uptime_ms();
+
+	if (rtc_clock_valid() && s_state.cal_sleep_ms > 0) {
+		int64_t err_ms = (int64_t) (utc_ms - (s_state.boot_utc_ms + uptime));
+		int64_t residual_ppm = err_ms * 1000000
+				/ (int64_t) s_state.cal_sleep_ms;
+		int64_t measured = s_state.drift_ppm + residual_ppm;
+
+		if (measured > -RTC_CLOCK_MAX_DRIFT_PPM
+				&& measured < RTC_CLOCK_MAX_DRIFT_PPM) {
+			s_state.drift_ppm += (int32_t) (residual_ppm
+					/ (1 << RTC_CLOCK_DRIFT_SHIFT));
+#if TEST_ON_PC == 0
+			printf("RTC clock: prediction off by %d ms, drift now %d ppm\n",
+					(int) err_ms, s_state.drift_ppm);
+#endif
+		}
+		s_state.cal_sleep_ms = 0;
+	}
+
+	s_state.boot_utc_ms = utc_ms - uptime;
+	s_state.valid = 1;
+}
+
+/**
+ * @brief Records the start of a deep sleep so the next boot can predict UTC.
+ *
+ * @param sleep_ms Requested sleep duration in milliseconds.
+ */
+void rtc_clock_prepare_sleep(uint32_t sleep_ms) {
+	if (!rtc_clock_valid())
+		return;
+	s_state.sleep_start_utc_ms = rtc_clock_now_ms();
+	s_state.sleep_req_ms = sleep_ms;
+}
+
+/**
+ * @brief Timer request for a deep sleep of about `sleep_sec` seconds.
+ *
+ * With a valid clock the wake-up is moved to the nearest multiple of the
+ * largest period in `s_align_sec` that fits in the sleep (an hourly sleep
+ * wakes on the hour, a 2 minute one on the minute), which changes the sleep
+ * by at most half that period. The wall-clock duration is then divided by
+ * (1 + drift) so the drifting RTC timer expires on the boundary.
+ *
+ * @param sleep_sec Nominal sleep chosen by the duty-cycle policy.
+ * @return Duration to pass to `esp_deep_sleep()` and
+ *         `rtc_clock_prepare_sleep()`, in milliseconds.
+ */
+uint32_t rtc_clock_schedule_ms(uint32_t sleep_sec) {
+	uint64_t wall_ms = (uint64_t) sleep_sec * 1000;
+
+	if (rtc_clock_valid() && sleep_sec >= RTC_CLOCK_MIN_ALIGN_SEC) {
+		uint64_t period_ms = RTC_CLOCK_MIN_ALIGN_SEC * 1000;
+		for (size_t i = 0; i < sizeof(s_align_sec) / sizeof(s_align_sec[0]);
+				i++) {
+			if (s_align_sec[i] <= sleep_sec) {
+				period_ms = (uint64_t) s_align_sec[i] * 1000;
+				break;
+			}
+		}
+
+		uint64_t now = rtc_clock_now_ms();
+		uint64_t target = (now + wall_ms + period_ms / 2) / period_ms
+				* period_ms;
+		wall_ms = target - now;
+	}
+
+	return (uint32_t) ((int64_t) wall_ms * 1000000
+			/ (1000000 + rtc_clock_drift_ppm()));
+}
+
+/**
+ * @brief Current drift coefficient of timed deep sleeps (ppm).
+ */
+int32_t rtc_clock_drift_ppm(void) {
+	return RTC_STATE_VALID(s_state) ? s_state.drift_ppm : 0;
+}
+
+/**
+ * @brief Days since 1970-01-01 for a proleptic Gregorian date.
+ */
+static int64_t days_from_civil(int y, int m, int d) {
+	y -= m <= 2;
+	int era = (y >= 0 ? y : y - 399) / 400;
+	int yoe = y - era * 400;
+	int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return (int64_t) era * 146097 + doe - 719468;
+}
+
+/**
+ * @brief Convert RMC time (`hhmmss.ss`) and date (`ddmmyy`) fields to UTC.
+ *
+ * @param hhmmss RMC field 2.
+ * @param ddmmyy RMC field 10.
+ * @return Milliseconds since the Unix epoch, or 0 if either field is invalid.
+ */
+uint64_t rtc_clock_from_nmea(const char *hhmmss, const char *ddmmyy) {
+	int hh, mm, ss, ms = 0;
+	int dd, mo, yy;
+
+	if (!hhmmss || !ddmmyy || strlen(hhmmss) < 6 || strlen(ddmmyy) != 6)
+		return 0;
+	if (sscanf(hhmmss, "%2d%2d%2d", &hh, &mm, &ss) != 3
+			|| sscanf(ddmmyy, "%2d%2d%2d", &dd, &mo, &yy) != 3)
+		return 0;
+	if (hhmmss[6] == '.') {
+		// One to three fractional digits, each worth a tenth of the previous
+		int scale = 100;
+		for (const char *p = hhmmss + 7; *p >= '0' && *p <= '9' && scale > 0;
+				p++, scale /= 10)
+			ms += (*p - '0') * scale;
+	}
+
+	if (hh > 23 || mm > 59 || ss > 60 || dd < 1 || dd > 31 || mo < 1
+			|| mo > 12)
+		return 0;
+
+	int64_t days = days_from_civil(2000 + yy, mo, dd);
+	int64_t sec = days * 86400 + hh * 3600 + mm * 60 + ss;
+	return (uint64_t) sec * 1000 + ms;
+}
+
+/**
+ * @brief Format a UTC time as `YYYY-MM-DD hh:mm:ss`.
+ *
+ * @param utc_ms  Milliseconds since the Unix epoch.
+ * @param out     Destination buffer (at least `RTC_CLOCK_STR_SIZE` bytes).
+ * @param out_len Size of the destination buffer in bytes.
+ */
+void rtc_clock_format(uint64_t utc_ms, char *out, size_t out_len) {
+	time_t t = (time_t) (utc_ms / 1000);
+	struct tm tm;
+
+	gmtime_r(&t, &tm);
+	strftime(out, out_len, "%Y-%m-%d %H:%M:%S", &tm);
+}
@@ -0,0 +1,57 @@
+/**
+ * @file rtc_clock.h
+ * @author yassine hattay
+ * @brief UTC timekeeping across deep sleep for ESP12/ESP8266.
+ *
+ * This module keeps a UTC clock that survives `esp_deep_sleep()`:
+ * - GPS time from the RMC sentence (fields 2 and 10) sets the clock.
+ * - Before each deep sleep the requested duration is stored in RTC memory,
+ *   and the wake time is predicted from it on the next boot.
+ * - Each GPS sync after a timed sleep measures the RTC slow-clock drift and
+ *   folds it into a ppm coefficient applied to later predictions.
+ * - Sleep requests are corrected by that coefficient and stretched or
+ *   shortened so wake-ups land on round wall-clock boundaries.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef RTC_CLOCK_H_
+#define RTC_CLOCK_H_
+
+#include "../my_config/my_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Shortest sleep used to measure drift (shorter ones are dominated by boot time) */
+#define RTC_CLOCK_MIN_CAL_SLEEP_MS 60000
+
+/** @brief Drift measurements outside +/- this range are rejected (ppm) */
+#define RTC_CLOCK_MAX_DRIFT_PPM 100000
+
+/** @brief Drift filter shift, each measurement moves the estimate by 1 / 2^shift */
+#define RTC_CLOCK_DRIFT_SHIFT 2
+
+/** @brief Sleeps shorter than this are not aligned to wall-clock boundaries (s) */
+#define RTC_CLOCK_MIN_ALIGN_SEC 60
+
+/** @brief Size of a buffer for rtc_clock_format() */
+#define RTC_CLOCK_STR_SIZE 24
+
+void rtc_clock_init(bool timer_wake);
+bool rtc_clock_valid(void);
+uint64_t rtc_clock_now_ms(void);
+void rtc_clock_sync(uint64_t utc_ms);
+void rtc_clock_prepare_sleep(uint32_t sleep_ms);
+uint32_t rtc_clock_schedule_ms(uint32_t sleep_sec);
+int32_t rtc_clock_drift_ppm(void);
+uint64_t rtc_clock_from_nmea(const char *hhmmss, const char *ddmmyy);
+void rtc_clock_format(uint64_t utc_ms, char *out, size_t out_len);
+
+#if TEST_ON_PC == 1
+void rtc_clock_host_set_uptime_ms(uint64_t uptime_ms);
+void rtc_clock_reset(void);
+#endif
+
+#endif /* RTC_CLOCK_H_ */
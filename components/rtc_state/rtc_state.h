@@ -0,0 +1,57 @@
+/**
+ * @file rtc_state.h
+ * @author yassine hattay
+ * @brief Component state blocks kept in RTC memory across deep sleep.
+ *
+ * RTC memory survives deep sleep but holds random bytes after power-on.
+ * Each block therefore starts with a `uint32_t magic` member, and a block
+ * whose magic does not match is treated as lost:
+ * - `RTC_STATE()` declares the block and its magic value.
+ * - `RTC_STATE_CLAIM()` zeroes and stamps a lost block before use.
+ * - `RTC_STATE_VALID()` tells whether the block survived.
+ * - `RTC_STATE_FORGET()` drops it, so the next claim starts from zero.
+ *
+ * Host builds (`TEST_ON_PC`) keep the blocks in ordinary memory.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef RTC_STATE_H_
+#define RTC_STATE_H_
+
+#include "../my_config/my_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if TEST_ON_PC == 0
+#include "esp_attr.h"
+#else
+#define RTC_DATA_ATTR
+#endif
+
+/** @brief Declares `name`, of a struct type starting with `uint32_t magic` */
+#define RTC_STATE(type, name, magic_value) \
+	static RTC_DATA_ATTR type name; \
+	static const uint32_t name##_magic = (magic_value)
+
+/** @brief Clears `name` unless it carries its magic; true if it was cleared */
+#define RTC_STATE_CLAIM(name) rtc_state_claim(&(name), sizeof(name), name##_magic)
+
+/** @brief true if `name` carries its magic */
+#define RTC_STATE_VALID(name) ((name).magic == name##_magic)
+
+/** @brief Marks `name` as lost */
+#define RTC_STATE_FORGET(name) ((name).magic = 0)
+
+static inline bool rtc_state_claim(void *state, size_t size, uint32_t magic) {
+	if (*(uint32_t *) state == magic)
+		return false;
+	memset(state, 0, size);
+	*(uint32_t *) state = magic;
+	return true;
+}
+
+#endif /* RTC_STATE_H_ */
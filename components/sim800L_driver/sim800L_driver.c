@@ -8,43 +8,53 @@
  * - Sending SMS messages with automatic retries and delivery report handling.
  * - Checking and waiting for network registration.
  * - Performing a soft reset if network registration fails.
- * - Controlling deep sleep timings before and after sending messages.
+ * - Reporting cell-tower information when the GPS could not get a fix.
+ * - Running uplink jobs handed over by the wake-cycle orchestrator.
  *
  * @version 0.1
  * @date 2025-09-09
  */
 
 #include "sim800L_driver.h"
+#if TEST_ON_PC == 0
 #include "driver/gpio.h"
 #include "driver/uart.h"
-#include "esp_sleep.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "driver/adc.h"
+#include "../wake_cycle/wake_cycle.h"
+#endif
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
-#include "driver/adc.h"
+#include <strings.h>
+#include "../duty_cycle/duty_cycle.h"
+#include "../rtc_clock/rtc_clock.h"
+#include "../battery/battery.h"
+#include "../energy/energy.h"
 
 /** @cond HIDDEN */
 const char phoneNumber[] = "+21650713097";
 /** @endcond */
 
-extern char smsMessage[64];
 
-/**
- * @brief Deep sleep duration (in seconds) if no SMS is sent (network fail).
- */
-uint64_t deep_sleep_time_sec = 10;
+TaskHandle_t sim_task_handle = NULL;
+
+/** @brief Link to the modem, bound by sim800_set_transport() */
+static transport_t *s_link;
 
 /**
- * @brief Deep sleep duration (in seconds) after a successful SMS send.
+ * @brief Binds the driver to the transport the modem is wired to.
+ *
+ * Must be called before the wake-cycle orchestrator starts an uplink.
  */
-uint64_t deep_sleep_time_sec_after_send = 10;
-
-TaskHandle_t sim_task_handle = NULL;
+void sim800_set_transport(transport_t *link) {
+    s_link = link;
+}
 
 
 /**
- * @brief Flushes and clears any pending data from the SIM800 UART input buffer.
+ * @brief Flushes and clears any pending data from the SIM800 input.
  *
  * This function continuously reads available bytes from the UART input buffer
  * until it is empty, discarding all data. It is typically called before sending
@@ -53,8 +63,7 @@ TaskHandle_t sim_task_handle = NULL;
  */
 static void flush_uart_input(void) {
     uint8_t flush_buf[128];
-    while (uart_read_bytes(UART_SIM800_NUM, flush_buf, sizeof(flush_buf),
-                           10 / portTICK_PERIOD_MS) > 0) {
+    while (transport_read(s_link, flush_buf, sizeof(flush_buf), 10) > 0) {
         vTaskDelay(1);
     }
 }
@@ -69,16 +78,16 @@ static void flush_uart_input(void) {
  * @param delay_ms  Time in milliseconds to wait after sending the command.
  */
 static void send_uart_command(const char *cmd, unsigned int delay_ms) {
-    uart_write_bytes(UART_NUM_0, cmd, strlen(cmd));
-    uart_write_bytes(UART_NUM_0, "\r\n", 2);
+    transport_write(s_link, cmd, strlen(cmd));
+    transport_write(s_link, "\r\n", 2);
     vTaskDelay(delay_ms);
 }
 
 
 /**
- * @brief Reads data from the SIM800 UART into a buffer.
+ * @brief Reads data from the SIM800 link into a buffer.
  *
- * This function continuously reads characters from the SIM800 UART until
+ * This function continuously reads characters from the SIM800 link until
  * either the buffer is full or the specified timeout expires.
  * It appends a null terminator (`'\0'`) at the end of the buffer to ensure
  * it can be safely used as a C-string.
@@ -95,11 +104,10 @@ static int read_uart_response(char *buffer, int bufsize, uint32_t timeout_ms) {
 
     while ((xTaskGetTickCount() - t_start) < pdMS_TO_TICKS(timeout_ms)
             && pos < (bufsize - 1)) {
-        uint8_t ch;
-        int len = uart_read_bytes(UART_SIM800_NUM, &ch, 1,
-                50 / portTICK_PERIOD_MS);
+        size_t len = transport_read(s_link, buffer + pos, bufsize - 1 - pos,
+                50);
         if (len > 0) {
-            buffer[pos++] = (char) ch;
+            pos += len;
         } else {
             vTaskDelay(pdMS_TO_TICKS(10));
         }
@@ -169,7 +177,7 @@ static bool send_sms(const char *number, const char *message) {
     // Prepare CMGS command
     char cmgs_cmd[64];
     snprintf(cmgs_cmd, sizeof(cmgs_cmd), "AT+CMGS=\"%s\"\r\n", number);
-    uart_write_bytes(UART_NUM_0, cmgs_cmd, strlen(cmgs_cmd));
+    transport_write(s_link, cmgs_cmd, strlen(cmgs_cmd));
 
     // Wait for '>' prompt
     char response[256] = {0};
@@ -179,16 +187,18 @@ static bool send_sms(const char *number, const char *message) {
     }
 
     // Send message text
-    uart_write_bytes(UART_NUM_0, message, strlen(message));
+    transport_write(s_link, message, strlen(message));
     vTaskDelay(pdMS_TO_TICKS(200));
 
-    // Send Ctrl+Z (end of SMS)
+    // Send Ctrl+Z (end of SMS), the module transmits until +CMGS / ERROR
     const uint8_t ctrl_z = 0x1A;
-    uart_write_bytes(UART_NUM_0, (const char*)&ctrl_z, 1);
+    energy_set(ENERGY_MODEM_TX, true);
+    transport_write(s_link, &ctrl_z, 1);
 
     // Wait for +CMGS confirmation or ERROR
     memset(response, 0, sizeof(response));
     len = read_uart_response(response, sizeof(response), 15000);
+    energy_set(ENERGY_MODEM_TX, false);
 
     if (strstr(response, "+CMGS:")) {
         return true;
@@ -200,89 +210,408 @@ static bool send_sms(const char *number, const char *message) {
 
 
 /**
- * @brief Main task for SIM800 operation.
+ * @brief Queries the serving and neighbour cells and builds a compact report.
  *
- * This FreeRTOS task handles:
- * - Measuring battery voltage.
- * - Initializing and configuring the SIM800 module.
- * - Waiting for network registration with retries.
- * - Preparing and sending an SMS with coordinates and battery voltage.
- * - Performing soft reset and deep sleep on failure or after sending.
+ * Enables SIM800 engineering mode with neighbour display (`AT+CENG=1,1`) and
+ * reads back the cell table with `AT+CENG?`. Each usable cell is written as
+ * one `lac,cellid,rxl` line (hexadecimal LAC/cell ID as reported by the
+ * module) after a `Cells: mcc,mnc` header taken from the serving cell, so the
+ * server can resolve an approximate position from a public cell database.
  *
- * @param arg Task argument (unused).
+ * Expected response lines:
+ * - serving:   `+CENG: 0,"arfcn,rxl,rxq,mcc,mnc,bsic,cellid,rla,txp,lac,ta"`
+ * - neighbour: `+CENG: n,"arfcn,rxl,bsic,cellid,mcc,mnc,lac"`
+ *
+ * @param out      Destination buffer for the report text.
+ * @param out_len  Size of the destination buffer in bytes.
+ * @return true if at least the serving cell was decoded, false otherwise.
  */
+static bool query_cell_info(char *out, size_t out_len) {
+	char response[512];
+
+	flush_uart_input();
+	send_uart_command("AT+CENG=1,1", 500);
+	flush_uart_input();
+	send_uart_command("AT+CENG?", 0);
+	read_uart_response(response, sizeof(response), 2000);
+	send_uart_command("AT+CENG=0", 200);
+
+	size_t pos = 0;
+	int cells = 0;
+	char *rest = response;
+	char *line;
+
+	while ((line = strtok_r(rest, "\r\n", &rest))) {
+		int idx;
+		char fields[96] = { 0 };
+		if (sscanf(line, "+CENG: %d,\"%95[^\"]\"", &idx, fields) != 2)
+			continue;
 
-void sim800_task(void *arg) {
+		char *f[11] = { 0 };
+		int n = 0;
+		char *frest = fields;
+		char *tok;
+		while (n < 11 && (tok = strsep(&frest, ",")))
+			f[n++] = tok;
+
+		const char *rxl, *mcc, *mnc, *cellid, *lac;
+		if (idx == 0 && n >= 10) {
+			rxl = f[1];
+			mcc = f[3];
+			mnc = f[4];
+			cellid = f[6];
+			lac = f[9];
+		} else if (idx > 0 && n >= 7) {
+			rxl = f[1];
+			cellid = f[3];
+			mcc = f[4];
+			mnc = f[5];
+			lac = f[6];
+		} else {
+			continue;
+		}
 
-	// --- Measure battery voltage ---
-	uint32_t adc_sum = 0;
-	const int samples = 100;
+		// Empty neighbour slots are reported with a zero or all-ones cell ID
+		if (strtol(cellid, NULL, 16) == 0 || strcasecmp(cellid, "ffff") == 0)
+			continue;
+
+		int w;
+		if (cells == 0) {
+			if (idx != 0)
+				continue; // Serving cell must come first to anchor the report
+			w = snprintf(out + pos, out_len - pos, "Cells: %s,%s\n", mcc, mnc);
+			if (w < 0 || (size_t) w >= out_len - pos)
+				break;
+			pos += w;
+		}
 
-	for (int i = 0; i < samples; i++) {
-		uint16_t adc_val;
-		if (adc_read(&adc_val) == ESP_OK) {
-			adc_sum += adc_val;
+		w = snprintf(out + pos, out_len - pos, "%s,%s,%s\n", lac, cellid, rxl);
+		if (w < 0 || (size_t) w >= out_len - pos) {
+			out[pos] = '\0'; // Keep whatever complete lines already fit
+			printf("query_cell_info: report full after %d cells\n", cells);
+			break;
 		}
-		vTaskDelay(pdMS_TO_TICKS(5));
+		pos += w;
+		cells++;
 	}
 
-	float adc_avg = adc_sum / (float) samples;
-	float adc_ref_scale = 0.8f / 738.0f;
-	float v_adc = adc_avg * adc_ref_scale;
-	float divider_ratio = 0.258f;
-	float v_bat = v_adc / divider_ratio;
+	if (cells == 0)
+		return false;
+
+	if (pos > 0 && out[pos - 1] == '\n')
+		out[--pos] = '\0';
+
+	printf("Cell report (%d cells):\n%s\n", cells, out);
+	return true;
+}
 
-	printf("Battery voltage: %.2f V\n", v_bat);
-	if (v_bat <= 3.40f) {
+/**
+ * @brief Asks the SIM800 location service for a coarse position.
+ *
+ * Opens a GPRS bearer on `SIM800_CLBS_APN` and issues `AT+CLBS=1,1`, which
+ * returns `+CLBS: 0,<lon>,<lat>,<accuracy>` when the network-based lookup
+ * succeeds. The bearer is closed again before returning. Disabled when
+ * `SIM800_CLBS_APN` is empty, since it needs a data plan on the SIM.
+ *
+ * @param out      Destination buffer for the report text.
+ * @param out_len  Size of the destination buffer in bytes.
+ * @return true if a coarse location was obtained, false otherwise.
+ */
+static bool query_clbs_location(char *out, size_t out_len) {
+	if (strlen(SIM800_CLBS_APN) == 0)
+		return false;
+
+	char cmd[64];
+	char response[256];
+
+	send_uart_command("AT+SAPBR=3,1,\"CONTYPE\",\"GPRS\"", 500);
+	snprintf(cmd, sizeof(cmd), "AT+SAPBR=3,1,\"APN\",\"%s\"", SIM800_CLBS_APN);
+	send_uart_command(cmd, 500);
+
+	// GPRS bearer up: the module transmits until it is closed again
+	energy_set(ENERGY_MODEM_TX, true);
+	send_uart_command("AT+SAPBR=1,1", 3000);
+
+	flush_uart_input();
+	send_uart_command("AT+CLBS=1,1", 0);
+	read_uart_response(response, sizeof(response), 10000);
+
+	send_uart_command("AT+SAPBR=0,1", 1000);
+	energy_set(ENERGY_MODEM_TX, false);
+
+	char *p = strstr(response, "+CLBS:");
+	int loc_code = -1, accuracy = 0;
+	char lon[16] = { 0 }, lat[16] = { 0 };
+	if (!p
+			|| sscanf(p, "+CLBS: %d,%15[^,],%15[^,],%d", &loc_code, lon, lat,
+					&accuracy) != 4 || loc_code != 0)
+		return false;
+
+	snprintf(out, out_len, "Approx: %s, %s\nAccuracy: %d m", lat, lon,
+			accuracy);
+	printf("CLBS location: %s\n", out);
+	return true;
+}
+
+/**
+ * @brief Formats the battery line appended to every report.
+ *
+ * Reads the filtered voltage from the background battery monitor (no ADC
+ * wait on this path) and, once a transmission has been observed, the sag
+ * under SIM800 load.
+ *
+ * @param out      Destination buffer for the text.
+ * @param out_len  Size of the destination buffer in bytes.
+ */
+static void format_battery(char *out, size_t out_len) {
+	uint32_t mv = battery_get_mv();
+	uint32_t sag_mv = battery_get_sag_mv();
+
+	printf("Battery voltage: %u mV (sag %u mV)\n", mv, sag_mv);
+	if (mv <= BATTERY_LOW_MV) {
 		printf("Battery low!\n");
 	}
 
+	int w = snprintf(out, out_len, "Battery: %u.%02u V", mv / 1000,
+			(mv % 1000) / 10);
+	if (sag_mv > 0 && w > 0 && (size_t) w < out_len)
+		snprintf(out + w, out_len - w, "\nSag: %u mV", sag_mv);
+}
+
+/**
+ * @brief Powers the SIM800 and brings it into command mode.
+ *
+ * Enables the SIM800 supply through the MOSFET, waits for the module to boot
+ * and disables command echo. Battery samples taken from here on are tagged
+ * as loaded.
+ */
+static void sim800_power_on(void) {
 	gpio_set_level(SIM_gpio, 0);
+	energy_set(ENERGY_SIM, true);
+	battery_set_load(true);
 
 	vTaskDelay(pdMS_TO_TICKS(10000));
 	sim_task_handle = xTaskGetCurrentTaskHandle();
 
 	send_uart_command("AT", 1000);
 	send_uart_command("ATE0", 1000);
+}
 
-	while (1) {
+/**
+ * @brief Reads the received signal strength with `AT+CSQ`.
+ *
+ * @return RSSI value 0..31, 99 if not detectable, or -1 if no valid reply.
+ */
+static int query_signal_quality(void) {
+	char response[64];
+	int rssi = -1, ber;
+
+	flush_uart_input();
+	send_uart_command("AT+CSQ", 0);
+	read_uart_response(response, sizeof(response), 500);
+
+	char *p = strstr(response, "+CSQ:");
+	if (!p || sscanf(p, "+CSQ: %d,%d", &rssi, &ber) != 2)
+		return -1;
+	return rssi;
+}
+
+/**
+ * @brief Waits for network registration, resetting the SIM800 once if needed.
+ *
+ * The signal quality is recorded for the duty-cycle policy (99 if the
+ * module never registered).
+ *
+ * @return true if the SIM800 is registered.
+ */
+static bool sim800_require_network(void) {
+	if (!wait_for_network()) {
+		soft_reset();
 		if (!wait_for_network()) {
-			soft_reset();
-			if (!wait_for_network()) {
-				gpio_set_level(SIM_gpio, 1);
-				esp_deep_sleep(deep_sleep_time_sec * 1000000ULL);
-			}
+			duty_cycle_record_signal(99);
+			return false;
 		}
+	}
 
-		// --- Prepare SMS ---
-		char sms_with_voltage[128];
+	duty_cycle_record_signal(query_signal_quality());
+	return true;
+}
 
-		if (strlen(smsMessage) == 0) {
-			snprintf(sms_with_voltage, sizeof(sms_with_voltage),
-					"Coords: 36.38101236495415, 9.50555854663195\nBattery: %.2f V",
-					v_bat);
-		} else {
-			snprintf(sms_with_voltage, sizeof(sms_with_voltage),
-					"%s\nBattery: %.2f V", smsMessage, v_bat);
+/**
+ * @brief Sends a report SMS with up to `SMS_MAX_RETRIES` attempts.
+ *
+ * @param text The complete SMS body to send.
+ * @return true if one of the attempts was accepted by the network.
+ */
+static bool send_sms_with_retries(const char *text) {
+	for (int attempt = 1; attempt <= SMS_MAX_RETRIES; attempt++) {
+		if (send_sms(phoneNumber, text)) {
+			return true;
 		}
+		vTaskDelay(pdMS_TO_TICKS(2000));
+	}
+	return false;
+}
+
+/**
+ * @brief Copies the complete lines of `text` that fit in `out`.
+ *
+ * @param out     Destination buffer, at least one byte.
+ * @param out_len Size of the destination buffer in bytes.
+ * @param text    Text to copy.
+ * @return true if the whole text fit, false if lines were dropped.
+ */
+static bool copy_whole_lines(char *out, size_t out_len, const char *text) {
+	size_t len = strlen(text);
+	size_t keep = 0;
 
-		// --- Send SMS ---
-		bool sms_sent = false;
+	if (len < out_len) {
+		memcpy(out, text, len + 1);
+		return true;
+	}
+	for (size_t i = 0; i < out_len - 1; i++) {
+		if (text[i] == '\n')
+			keep = i;
+	}
+	memcpy(out, text, keep);
+	out[keep] = '\0';
+	return false;
+}
 
-		for (int attempt = 1; attempt <= SMS_MAX_RETRIES; attempt++) {
-			if (send_sms(phoneNumber, sms_with_voltage)) {
-				sms_sent = true;
-				break;
-			}
-			vTaskDelay(pdMS_TO_TICKS(2000));
+/**
+ * @brief Builds the SMS body of an uplink job.
+ *
+ * - Fix report: the text prepared by the orchestrator (`smsMessage`).
+ * - Cell report: a coarse `AT+CLBS` location when `SIM800_CLBS_APN` is
+ *   configured, otherwise (or if that fails) the serving and neighbour cell
+ *   table from `AT+CENG`, which the server resolves to an approximate
+ *   position, followed by the RTC clock time if known.
+ *
+ * The filtered battery voltage (and sag under load) and the energy ledger
+ * summary (`energy_format_report()`) are appended to both. Their room is
+ * reserved first: a report that does not fit loses its last lines (cells,
+ * geofence events), never the footer.
+ *
+ * @param cell    true for a cell-location report.
+ * @param out     Destination buffer.
+ * @param out_len Size of the destination buffer in bytes.
+ */
+static void sim800_build_report(bool cell, char *out, size_t out_len) {
+	char footer[48 + ENERGY_REPORT_STR_SIZE];
+
+	format_battery(footer, sizeof(footer));
+	size_t pos = strlen(footer);
+	if (pos + 1 < sizeof(footer)) {
+		footer[pos++] = '\n';
+		energy_format_report(footer + pos, sizeof(footer) - pos);
+	}
+
+	// What is left for the report once the footer and its '\n' are in
+	size_t footer_len = strlen(footer);
+	size_t body_size = out_len > footer_len + 2 ? out_len - footer_len - 1 : 1;
+
+	if (cell) {
+		char location[128] = { 0 };
+		char utc_line[8 + RTC_CLOCK_STR_SIZE] = "UTC: unknown";
+
+		if (rtc_clock_valid()) {
+			char utc[RTC_CLOCK_STR_SIZE];
+			rtc_clock_format(rtc_clock_now_ms(), utc, sizeof(utc));
+			snprintf(utc_line, sizeof(utc_line), "UTC: %s", utc);
 		}
 
-		if (!sms_sent) {
-			soft_reset();
-			continue;
+		size_t location_size = sizeof(location);
+		if (body_size < strlen(utc_line) + 2)
+			location_size = 1;
+		else if (body_size - strlen(utc_line) - 1 < location_size)
+			location_size = body_size - strlen(utc_line) - 1;
+
+		if (!query_clbs_location(location, location_size)
+				&& !query_cell_info(location, location_size)) {
+			snprintf(location, location_size, "No GPS fix, no cell info");
 		}
+		snprintf(out, body_size, "%s\n%s", location, utc_line);
+	} else if (strlen(smsMessage) == 0) {
+		snprintf(out, body_size,
+				"Coords: 36.38101236495415, 9.50555854663195");
+	} else if (!copy_whole_lines(out, body_size, smsMessage)) {
+		printf("sim800_build_report: fix report cut to %u of %u chars\n",
+				(unsigned) strlen(out), (unsigned) strlen(smsMessage));
+	}
+
+	pos = strlen(out);
+	snprintf(out + pos, out_len - pos, "\n%s", footer);
+}
 
-		gpio_set_level(SIM_gpio, 1);
-		esp_deep_sleep(deep_sleep_time_sec_after_send * 1000000ULL);
+/**
+ * @brief Runs one uplink job: registration, report and SMS.
+ *
+ * A send failure soft-resets the module and starts a new session, up to
+ * `SIM800_MAX_SESSIONS`. A module that does not register fails at once.
+ *
+ * @param cell true for a cell-location report, false for the fix report.
+ * @return true if the report was accepted by the network.
+ */
+static bool sim800_send_report(bool cell) {
+	char sms_with_voltage[160];
+
+	for (int session = 1; session <= SIM800_MAX_SESSIONS; session++) {
+		if (!sim800_require_network())
+			return false;
+
+		sim800_build_report(cell, sms_with_voltage, sizeof(sms_with_voltage));
+		if (send_sms_with_retries(sms_with_voltage))
+			return true;
+
+		soft_reset();
 	}
+	return false;
+}
+
+/**
+ * @brief Main task for SIM800 operation.
+ *
+ * Created once by the wake-cycle orchestrator, this FreeRTOS task sleeps
+ * until an uplink job is posted:
+ * - `WAKE_EVT_UPLINK_FIX`: send the fix report prepared in `smsMessage`.
+ * - `WAKE_EVT_UPLINK_CELL`: the GPS got no fix, send a network-derived
+ *   position instead.
+ *
+ * It powers the SIM800, sends the report with the battery voltage and
+ * answers with `WAKE_EVT_UPLINK_OK` or `WAKE_EVT_UPLINK_FAIL`. Powering the
+ * module down and sleeping are left to the orchestrator.
+ *
+ * @param arg Task argument (unused).
+ */
+#if TEST_ON_PC == 0
+void sim800_task(void *arg) {
+	while (1) {
+		EventBits_t job = wake_cycle_wait(
+				WAKE_EVT_UPLINK_FIX | WAKE_EVT_UPLINK_CELL, true);
+
+		sim800_power_on();
+		bool sent = sim800_send_report((job & WAKE_EVT_UPLINK_CELL) != 0);
+
+		wake_cycle_signal(sent ? WAKE_EVT_UPLINK_OK : WAKE_EVT_UPLINK_FAIL);
+	}
+}
+#else
+/**
+ * @brief Host counterpart of sim800_task(): runs one uplink job.
+ *
+ * Called by `host_sim800.py` with the slave side of a pty, the fake modem
+ * answering on the master side.
+ *
+ * @param fd   File descriptor the modem is reached on.
+ * @param cell true for a cell-location report, false for the fix report.
+ * @return true if the report was accepted by the network.
+ */
+bool sim800_host_uplink(int fd, bool cell) {
+	static transport_t link;
+
+	transport_fd_init(&link, fd, fd);
+	sim800_set_transport(&link);
+	sim800_power_on();
+	return sim800_send_report(cell);
 }
+#endif
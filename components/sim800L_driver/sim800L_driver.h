@@ -7,7 +7,8 @@
  * with the SIM800L module:
  * - Sending SMS with retries and delivery handling.
  * - Monitoring network registration.
- * - Triggering deep sleep before and after sending messages.
+ * - Running the uplink jobs of the wake-cycle orchestrator.
+ * - Reporting cell-tower information as a fallback when the GPS times out.
  *
  * @version 0.1
  * @date 2025-09-09
@@ -16,17 +17,22 @@
 #ifndef SIM800L_CONFIG_H_
 #define SIM800L_CONFIG_H_
 
+#include "../my_config/my_config.h"
+
+#if TEST_ON_PC == 0
 #include "../debugging/my_print.h"
 #include "../web/web.h"
 #include <driver/uart.h>
-#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "driver/adc.h"
+#else
+#include "sim800L_driver_tests.h"
+#endif
 
-/** @brief UART port used for SIM800 communication */
-#define UART_SIM800_NUM      UART_NUM_0
+#include <string.h>
+#include "../transport/transport.h"
 
 /** @brief Baud rate for SIM800 UART communication */
 #define UART_SIM800_BAUD     9600
@@ -40,6 +46,22 @@
 /** @brief Maximum number of retries if SMS sending fails */
 #define SMS_MAX_RETRIES 3
 
+/** @brief SIM800 sessions (soft reset in between) per uplink job */
+#define SIM800_MAX_SESSIONS 2
+
+/**
+ * @brief APN used for the `AT+CLBS` coarse location lookup.
+ *
+ * Leave empty to skip CLBS and report the raw `AT+CENG` cell table only
+ * (no data plan required).
+ */
+#define SIM800_CLBS_APN ""
+
+void sim800_set_transport(transport_t *link);
+#if TEST_ON_PC == 0
 void sim800_task(void *arg);
+#else
+bool sim800_host_uplink(int fd, bool cell);
+#endif
 
 #endif
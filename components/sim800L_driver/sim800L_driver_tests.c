@@ -0,0 +1,86 @@
+/**
+ * @file sim800L_driver_tests.c
+ * @author yassine hattay
+ * @brief Host stand-ins for the SIM800L driver (`TEST_ON_PC`).
+ *
+ * See `sim800L_driver_tests.h`. Only built by `host_sim800.py`.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "../my_config/my_config.h"
+
+#if TEST_ON_PC == 1
+
+#include "sim800L_driver_tests.h"
+#include "../battery/battery.h"
+#include "../energy/energy.h"
+#include <time.h>
+
+char smsMessage[SMS_MESSAGE_SIZE] = { 0 };
+
+static uint32_t s_battery_mv = 3900;
+static uint32_t s_battery_sag_mv = 0;
+
+TickType_t xTaskGetTickCount(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (TickType_t) ((uint64_t) ts.tv_sec * configTICK_RATE_HZ
+			+ ts.tv_nsec / (1000000000 / configTICK_RATE_HZ));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	return (TaskHandle_t) 1;
+}
+
+void vTaskDelay(TickType_t ticks) {
+	uint64_t ns = (uint64_t) ticks * (1000000000 / configTICK_RATE_HZ);
+	struct timespec ts = { .tv_sec = ns / 1000000000, .tv_nsec = ns
+			% 1000000000 };
+
+	while (nanosleep(&ts, &ts) != 0) {
+	}
+}
+
+int gpio_set_level(int gpio_num, uint32_t level) {
+	return 0;
+}
+
+uint32_t battery_get_mv(void) {
+	return s_battery_mv;
+}
+
+uint32_t battery_get_sag_mv(void) {
+	return s_battery_sag_mv;
+}
+
+void battery_set_load(bool loaded) {
+}
+
+void energy_set(uint32_t flags, bool on) {
+}
+
+/**
+ * @brief Same text as the ledger's, with a long-running total so the
+ * footer has its field-worst width.
+ */
+size_t energy_format_report(char *out, size_t out_len) {
+	int n = snprintf(out, out_len, "Energy: %s mAh, %s/report", "1234.56",
+			"12.34");
+	if (n < 0)
+		return 0;
+	return (size_t) n < out_len ? (size_t) n : (out_len ? out_len - 1 : 0);
+}
+
+void sim_set_fix(const char *text) {
+	snprintf(smsMessage, sizeof(smsMessage), "%s", text);
+}
+
+void sim_set_battery(uint32_t mv, uint32_t sag_mv) {
+	s_battery_mv = mv;
+	s_battery_sag_mv = sag_mv;
+}
+
+#endif
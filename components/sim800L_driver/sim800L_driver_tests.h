@@ -0,0 +1,50 @@
+/**
+ * @file sim800L_driver_tests.h
+ * @author yassine hattay
+ * @brief Host stand-ins for the SDK calls of the SIM800L driver (`TEST_ON_PC`).
+ *
+ * Only the types, constants and functions `sim800L_driver.c` uses are
+ * declared. They are implemented in `sim800L_driver_tests.c`:
+ * - Ticks and delays follow the host monotonic clock (1 kHz tick, as in
+ *   `sdkconfig`), so the driver runs with its real timing.
+ * - The battery monitor and the energy ledger return fixed values set with
+ *   `sim_set_battery()`.
+ * - `smsMessage`, the fix report of the wake-cycle orchestrator, is set
+ *   with `sim_set_fix()`.
+ *
+ * `host_sim800.py` binds the driver to a pty with `sim800_host_uplink()`
+ * and answers it with a fake modem.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef SIM800L_DRIVER_TESTS_H_
+#define SIM800L_DRIVER_TESTS_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t) ((uint64_t) (ms) * configTICK_RATE_HZ / 1000))
+
+/** @brief Size of the orchestrator's fix report, as in `wake_cycle.h` */
+#define SMS_MESSAGE_SIZE 112
+
+extern char smsMessage[SMS_MESSAGE_SIZE];
+
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void vTaskDelay(TickType_t ticks);
+int gpio_set_level(int gpio_num, uint32_t level);
+
+/* Simulation control, called by host_sim800.py */
+void sim_set_fix(const char *text);
+void sim_set_battery(uint32_t mv, uint32_t sag_mv);
+
+#endif /* SIM800L_DRIVER_TESTS_H_ */
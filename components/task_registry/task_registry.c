@@ -0,0 +1,120 @@
+/**
+ * @file task_registry.c
+ * @author yassine hattay
+ * @brief Static task registry for ESP12/ESP8266.
+ *
+ * The registry owns one statically allocated stack and TCB per task in
+ * `task_id_t`. Stack depths come from `task_stacks.h`, which is regenerated
+ * from the high-water marks printed by `task_registry_report()`, so RAM
+ * saved by right-sizing the stacks is known at link time instead of
+ * showing up (or not) as free heap.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "task_registry.h"
+#include <stdio.h>
+#include "esp_system.h"
+
+/** @brief Static description of a registered task */
+typedef struct {
+	const char *name;
+	uint32_t depth;      ///< Stack depth in StackType_t units
+	UBaseType_t priority;
+	StackType_t *stack;
+} task_registry_entry_t;
+
+static StackType_t s_stack_ota[TASK_STACK_OTA];
+static StackType_t s_stack_wake_cycle[TASK_STACK_WAKE_CYCLE];
+static StackType_t s_stack_gps[TASK_STACK_GPS];
+static StackType_t s_stack_sim800[TASK_STACK_SIM800];
+static StackType_t s_stack_battery[TASK_STACK_BATTERY];
+static StackType_t s_stack_uart_rx[TASK_STACK_UART_RX];
+
+// Names must match the TASK_STACK_* macros known to host_task_stacks.py
+static const task_registry_entry_t s_tasks[TASK_ID_COUNT] = {
+	[TASK_ID_OTA] = { "ota_task", TASK_STACK_OTA, 11, s_stack_ota },
+	[TASK_ID_WAKE_CYCLE] = { "wake_cycle", TASK_STACK_WAKE_CYCLE, 10,
+			s_stack_wake_cycle },
+	[TASK_ID_GPS] = { "gps_task", TASK_STACK_GPS, 9, s_stack_gps },
+	[TASK_ID_SIM800] = { "sim800_task", TASK_STACK_SIM800, 5, s_stack_sim800 },
+	[TASK_ID_BATTERY] = { "battery", TASK_STACK_BATTERY, 2, s_stack_battery },
+	[TASK_ID_UART_RX] = { "uart_rx_task", TASK_STACK_UART_RX, 4,
+			s_stack_uart_rx },
+};
+
+static StaticTask_t s_tcb[TASK_ID_COUNT];
+static TaskHandle_t s_handles[TASK_ID_COUNT];
+
+/**
+ * @brief Creates a registered task on its static stack.
+ *
+ * @param id  Task to create. Each task can only be created once.
+ * @param fn  Task function.
+ * @param arg Task argument.
+ * @return The task handle, or NULL if `id` is invalid or already running.
+ */
+TaskHandle_t task_registry_create(task_id_t id, TaskFunction_t fn, void *arg) {
+	if (id >= TASK_ID_COUNT || s_handles[id] != NULL) {
+		printf("task_registry_create: task %d invalid or already created\n",
+				id);
+		return NULL;
+	}
+
+	const task_registry_entry_t *t = &s_tasks[id];
+	s_handles[id] = xTaskCreateStatic(fn, t->name, t->depth, arg, t->priority,
+			t->stack, &s_tcb[id]);
+	return s_handles[id];
+}
+
+/**
+ * @brief Handle of a registered task, NULL if it was not created.
+ */
+TaskHandle_t task_registry_handle(task_id_t id) {
+	return id < TASK_ID_COUNT ? s_handles[id] : NULL;
+}
+
+/**
+ * @brief Writes the heap and stack headroom report into a buffer.
+ *
+ * One "Task stack:" line per created task gives its peak use and depth in
+ * stack units, the format `host_task_stacks.py` parses.
+ *
+ * @param out     Destination buffer.
+ * @param out_len Size of the destination buffer in bytes.
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t task_registry_format(char *out, size_t out_len) {
+	size_t pos = 0;
+	int n = snprintf(out, out_len, "Heap: free %u, minimum free %u bytes\n",
+			esp_get_free_heap_size(), esp_get_minimum_free_heap_size());
+	if (n < 0 || (size_t) n >= out_len)
+		return out_len ? out_len - 1 : 0;
+	pos = n;
+
+	for (int i = 0; i < TASK_ID_COUNT; i++) {
+		if (s_handles[i] == NULL)
+			continue;
+
+		uint32_t free_units = uxTaskGetStackHighWaterMark(s_handles[i]);
+		n = snprintf(out + pos, out_len - pos,
+				"Task stack: %-12s peak %5u of %5u (headroom %u)\n",
+				s_tasks[i].name, s_tasks[i].depth - free_units,
+				s_tasks[i].depth, free_units);
+		if (n < 0 || (size_t) n >= out_len - pos)
+			return out_len - 1;
+		pos += n;
+	}
+	return pos;
+}
+
+/**
+ * @brief Prints the heap and stack headroom report to the console.
+ */
+void task_registry_report(void) {
+	static char report[768];
+
+	task_registry_format(report, sizeof(report));
+	printf("%s", report);
+}
@@ -0,0 +1,45 @@
+/**
+ * @file task_registry.h
+ * @author yassine hattay
+ * @brief Static task registry for ESP12/ESP8266.
+ *
+ * Every FreeRTOS task of the firmware is listed here with its priority and
+ * a stack depth taken from the generated `task_stacks.h`:
+ * - Tasks are created with `xTaskCreateStatic()`, so their stacks and TCBs
+ *   live in .bss and never fragment the ~80 KB heap.
+ * - `task_registry_report()` prints the free heap and the stack headroom of
+ *   each task. Its "Task stack:" lines feed `host_task_stacks.py`, which
+ *   regenerates the stack table from the measured peaks.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef TASK_REGISTRY_H_
+#define TASK_REGISTRY_H_
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "task_stacks.h"
+
+/** @brief Smallest stack depth the generator will emit */
+#define TASK_STACK_MIN 768
+
+/** @brief Registered tasks */
+typedef enum {
+	TASK_ID_OTA = 0,
+	TASK_ID_WAKE_CYCLE,
+	TASK_ID_GPS,
+	TASK_ID_SIM800,
+	TASK_ID_BATTERY,
+	TASK_ID_UART_RX,
+	TASK_ID_COUNT
+} task_id_t;
+
+TaskHandle_t task_registry_create(task_id_t id, TaskFunction_t fn, void *arg);
+TaskHandle_t task_registry_handle(task_id_t id);
+void task_registry_report(void);
+size_t task_registry_format(char *out, size_t out_len);
+
+#endif /* TASK_REGISTRY_H_ */
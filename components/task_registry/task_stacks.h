@@ -0,0 +1,28 @@
+/**
+ * @file task_stacks.h
+ * @brief Stack depth of every registered task.
+ *
+ * Rewritten by host_task_stacks.py from the "Task stack:" lines printed by
+ * task_registry_report() during a profiling run:
+ *
+ *     python3 host_task_stacks.py monitor.log
+ *
+ * Depth = peak use * 5/4, rounded up to 256, at least TASK_STACK_MIN.
+ * Entries marked "not profiled yet" keep the task's stack size from before
+ * the registry, unchanged until a log covers the task.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef TASK_STACKS_H_
+#define TASK_STACKS_H_
+
+#define TASK_STACK_OTA        4096 // peak: not profiled yet
+#define TASK_STACK_WAKE_CYCLE 3072 // peak: not profiled yet
+#define TASK_STACK_GPS        4096 // peak: not profiled yet
+#define TASK_STACK_SIM800     4096 // peak: not profiled yet
+#define TASK_STACK_BATTERY    2048 // peak: not profiled yet
+#define TASK_STACK_UART_RX    4096 // peak: not profiled yet
+
+#endif /* TASK_STACKS_H_ */
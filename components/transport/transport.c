@@ -0,0 +1,307 @@
+/**
+ * @file transport.c
+ * @author yassine hattay
+ * @brief Byte-transport backends for ESP12/ESP8266 peripheral drivers.
+ *
+ * The hardware UART backend copies through the ESP driver ring into a
+ * small span buffer; the soft UART backend hands out its receive ring in
+ * place. On the host (`TEST_ON_PC`) only the file-descriptor backend is
+ * built.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "transport.h"
+#include <string.h>
+
+#if TEST_ON_PC == 0
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#else
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Waits up to `timeout_ms` for received bytes and gives the next
+ * contiguous run of them in place.
+ *
+ * The span stays valid until `transport_consume()` or the next read.
+ *
+ * @return Length of the span, 0 on timeout.
+ */
+size_t transport_read_span(transport_t *t, const uint8_t **span,
+		uint32_t timeout_ms) {
+	return t->ops->read_span(t, span, timeout_ms);
+}
+
+/**
+ * @brief Releases `len` bytes of the last span.
+ */
+void transport_consume(transport_t *t, size_t len) {
+	t->ops->consume(t, len);
+}
+
+/**
+ * @brief Copies up to `len` received bytes.
+ *
+ * Waits up to `timeout_ms` for the first byte only, then takes whatever
+ * else is already received.
+ *
+ * @return Number of bytes copied, 0 on timeout.
+ */
+size_t transport_read(transport_t *t, void *out, size_t len,
+		uint32_t timeout_ms) {
+	uint8_t *dst = out;
+	const uint8_t *span;
+	size_t total = 0;
+
+	while (total < len) {
+		size_t n = t->ops->read_span(t, &span, total ? 0 : timeout_ms);
+		if (n == 0)
+			break;
+		if (n > len - total)
+			n = len - total;
+		memcpy(dst + total, span, n);
+		t->ops->consume(t, n);
+		total += n;
+	}
+	return total;
+}
+
+/**
+ * @brief Waits up to `timeout_ms` until received bytes are waiting.
+ */
+bool transport_wait(transport_t *t, uint32_t timeout_ms) {
+	const uint8_t *span;
+	return t->ops->read_span(t, &span, timeout_ms) > 0;
+}
+
+/**
+ * @brief Sends `len` bytes.
+ *
+ * @return Number of bytes accepted, or -1 on error.
+ */
+int transport_write(transport_t *t, const void *data, size_t len) {
+	return t->ops->write(t, data, len);
+}
+
+/**
+ * @brief Waits up to `timeout_ms` until every written byte left the chip.
+ *
+ * @return false on timeout.
+ */
+bool transport_flush(transport_t *t, uint32_t timeout_ms) {
+	return t->ops->flush(t, timeout_ms);
+}
+
+/**
+ * @brief `consume` of the backends reading into `t->buf`.
+ */
+static void buffered_consume(transport_t *t, size_t len) {
+	t->pos += len;
+}
+
+#if TEST_ON_PC == 0
+
+/**
+ * @brief Reads from the ESP UART driver.
+ *
+ * Blocks for the first byte only, so the call returns as soon as anything
+ * arrived, then takes what else the driver already buffered.
+ */
+static size_t uart_read_span(transport_t *t, const uint8_t **span,
+		uint32_t timeout_ms) {
+	if (t->pos == t->len) {
+		size_t avail = 0;
+		int n = 0;
+
+		t->pos = t->len = 0;
+		uart_get_buffered_data_len(t->port, &avail);
+		if (avail == 0) {
+			n = uart_read_bytes(t->port, t->buf, 1, pdMS_TO_TICKS(timeout_ms));
+			if (n <= 0)
+				return 0;
+			uart_get_buffered_data_len(t->port, &avail);
+		}
+		if (avail > sizeof(t->buf) - n)
+			avail = sizeof(t->buf) - n;
+		if (avail > 0) {
+			int more = uart_read_bytes(t->port, t->buf + n, avail, 0);
+			n += more > 0 ? more : 0;
+		}
+		t->len = n;
+	}
+
+	*span = t->buf + t->pos;
+	return t->len - t->pos;
+}
+
+static int uart_write(transport_t *t, const void *data, size_t len) {
+	return uart_write_bytes(t->port, data, len);
+}
+
+static bool uart_flush(transport_t *t, uint32_t timeout_ms) {
+	return uart_wait_tx_done(t->port, pdMS_TO_TICKS(timeout_ms)) == ESP_OK;
+}
+
+static const transport_ops_t s_uart_ops = { uart_read_span, buffered_consume,
+		uart_write, uart_flush };
+
+/**
+ * @brief Binds a transport to a hardware UART and installs its driver.
+ *
+ * UART0 is the full-duplex port shared with the console. UART1 only has a
+ * TX pin (GPIO2, the soft UART TX pin too, so use one or the other): set
+ * `rx_enabled` to 0 and reads simply time out.
+ *
+ * @param t    Transport to set up.
+ * @param uart Port and line settings, passed to `my_uart_init()`.
+ * @return The driver installation error, if any.
+ */
+esp_err_t transport_uart_init(transport_t *t, uart_t *uart) {
+	esp_err_t err = my_uart_init(uart);
+	if (err != ESP_OK) {
+		printf("transport_uart_init: UART%d driver failed, error: %d\n",
+				uart->uart_nr, err);
+		return err;
+	}
+
+	t->ops = &s_uart_ops;
+	t->name = uart->uart_nr == UART_NUM_0 ? "uart0" : "uart1";
+	t->port = uart->uart_nr;
+	t->pos = t->len = 0;
+	return ESP_OK;
+}
+
+/**
+ * @brief Gives the soft UART receive ring in place.
+ */
+static size_t soft_read_span(transport_t *t, const uint8_t **span,
+		uint32_t timeout_ms) {
+	size_t n = soft_uart_read_span(span);
+	if (n == 0 && soft_uart_rx_wait(pdMS_TO_TICKS(timeout_ms)))
+		n = soft_uart_read_span(span);
+	return n;
+}
+
+static void soft_consume(transport_t *t, size_t len) {
+	soft_uart_consume(len);
+}
+
+static int soft_write(transport_t *t, const void *data, size_t len) {
+	uart_bitbang_send_string(data, len);
+	return len;
+}
+
+static bool soft_flush(transport_t *t, uint32_t timeout_ms) {
+	return soft_uart_tx_wait(pdMS_TO_TICKS(timeout_ms));
+}
+
+static const transport_ops_t s_soft_uart_ops = { soft_read_span, soft_consume,
+		soft_write, soft_flush };
+
+/**
+ * @brief Binds a transport to the soft UART (`RX_PIN` / `TX_PIN`) and
+ * starts both directions.
+ *
+ * The soft UART is half duplex: bytes arriving while a write is on the
+ * wire are lost, which suits command / response peripherals.
+ *
+ * @return The first initialization error, if any.
+ */
+esp_err_t transport_soft_uart_init(transport_t *t) {
+	esp_err_t err = soft_uart_rx_init();
+	if (err == ESP_OK)
+		err = init_transmit();
+	if (err != ESP_OK)
+		return err;
+
+	t->ops = &s_soft_uart_ops;
+	t->name = "soft_uart";
+	t->port = -1;
+	t->pos = t->len = 0;
+	return ESP_OK;
+}
+
+#else
+
+/**
+ * @brief Reads from the host file descriptor, after `poll()` says it is
+ * readable.
+ */
+static size_t fd_read_span(transport_t *t, const uint8_t **span,
+		uint32_t timeout_ms) {
+	if (t->pos == t->len) {
+		struct pollfd pfd = { .fd = t->port, .events = POLLIN };
+
+		t->pos = t->len = 0;
+		if (poll(&pfd, 1, timeout_ms) <= 0)
+			return 0;
+		ssize_t n = read(t->port, t->buf, sizeof(t->buf));
+		if (n <= 0)
+			return 0;
+		t->len = n;
+	}
+
+	*span = t->buf + t->pos;
+	return t->len - t->pos;
+}
+
+static int fd_write(transport_t *t, const void *data, size_t len) {
+	const uint8_t *src = data;
+	size_t done = 0;
+
+	while (done < len) {
+		ssize_t n = write(t->tx_fd, src + done, len - done);
+		if (n < 0)
+			return -1;
+		done += n;
+	}
+	return done;
+}
+
+/**
+ * @brief Waits until the tty output queue of `tx_fd` is empty.
+ *
+ * Polls `TIOCOUTQ` every millisecond rather than calling `tcdrain()`,
+ * which has no timeout. Pipes and files have no queue to drain.
+ */
+static bool fd_flush(transport_t *t, uint32_t timeout_ms) {
+	int pending = 0;
+
+	if (!isatty(t->tx_fd))
+		return true;
+	for (uint32_t waited = 0;; waited++) {
+		if (ioctl(t->tx_fd, TIOCOUTQ, &pending) != 0)
+			return false;
+		if (pending == 0)
+			return true;
+		if (waited >= timeout_ms)
+			return false;
+		usleep(1000);
+	}
+}
+
+static const transport_ops_t s_fd_ops = { fd_read_span, buffered_consume,
+		fd_write, fd_flush };
+
+/**
+ * @brief Binds a transport to host file descriptors.
+ *
+ * @param t     Transport to set up.
+ * @param rx_fd Read side: a pty master, a pipe or a capture file.
+ * @param tx_fd Write side, may be the same descriptor as `rx_fd`.
+ */
+void transport_fd_init(transport_t *t, int rx_fd, int tx_fd) {
+	t->ops = &s_fd_ops;
+	t->name = "fd";
+	t->port = rx_fd;
+	t->tx_fd = tx_fd;
+	t->pos = t->len = 0;
+}
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * @file transport.h
+ * @author yassine hattay
+ * @brief Byte-transport interface for ESP12/ESP8266 peripheral drivers.
+ *
+ * Drivers talk to their peripheral through a `transport_t` bound at init
+ * time instead of a hardcoded UART port:
+ * - `transport_read_span()` gives received bytes in place, released with
+ *   `transport_consume()`; `transport_read()` copies them instead.
+ * - `transport_wait()` blocks until bytes are received.
+ * - `transport_write()` sends, `transport_flush()` waits for the bytes to
+ *   leave the chip.
+ *
+ * Backends: hardware UART0 or UART1 (TX only, on GPIO2), the soft UART of
+ * `components/UART`, and on the host a pair of file descriptors (a pty,
+ * a pipe or a capture file), so drivers and their timing can be run and
+ * benchmarked without the board.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef TRANSPORT_H_
+#define TRANSPORT_H_
+
+#include "../my_config/my_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if TEST_ON_PC == 0
+#include "../UART/UART.h"
+#endif
+
+/** @brief Bytes a hardware or host backend reads per span */
+#define TRANSPORT_SPAN_SIZE 128
+
+typedef struct transport transport_t;
+
+/** @brief Backend operations */
+typedef struct {
+	/** Waits up to `timeout_ms` for data, then gives a span in place */
+	size_t (*read_span)(transport_t *t, const uint8_t **span,
+			uint32_t timeout_ms);
+	/** Releases bytes of the last span */
+	void (*consume)(transport_t *t, size_t len);
+	/** Sends `len` bytes, returns the number accepted or -1 */
+	int (*write)(transport_t *t, const void *data, size_t len);
+	/** Waits up to `timeout_ms` until everything written left the chip */
+	bool (*flush)(transport_t *t, uint32_t timeout_ms);
+} transport_ops_t;
+
+/** @brief A bound transport, set up by one of the backend init functions */
+struct transport {
+	const transport_ops_t *ops;
+	const char *name;
+	int port;                          ///< UART number, or RX file descriptor
+	int tx_fd;                         ///< Host backend TX file descriptor
+	uint8_t buf[TRANSPORT_SPAN_SIZE];  ///< Span storage of copying backends
+	size_t pos;                        ///< Next unread byte in `buf`
+	size_t len;                        ///< Bytes held in `buf`
+};
+
+size_t transport_read_span(transport_t *t, const uint8_t **span,
+		uint32_t timeout_ms);
+void transport_consume(transport_t *t, size_t len);
+size_t transport_read(transport_t *t, void *out, size_t len,
+		uint32_t timeout_ms);
+bool transport_wait(transport_t *t, uint32_t timeout_ms);
+int transport_write(transport_t *t, const void *data, size_t len);
+bool transport_flush(transport_t *t, uint32_t timeout_ms);
+
+#if TEST_ON_PC == 0
+esp_err_t transport_uart_init(transport_t *t, uart_t *uart);
+esp_err_t transport_soft_uart_init(transport_t *t);
+#else
+void transport_fd_init(transport_t *t, int rx_fd, int tx_fd);
+#endif
+
+#endif /* TRANSPORT_H_ */
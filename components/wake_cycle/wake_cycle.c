@@ -0,0 +1,325 @@
+/**
+ * @file wake_cycle.c
+ * @author yassine hattay
+ * @brief Wake-cycle orchestrator for ESP12/ESP8266.
+ *
+ * The orchestrator task walks the phases of `wake_phase_t` in order and is
+ * the only place that decides what happens next. Worker tasks block on
+ * their start bit, do one job and report back with a result bit:
+ * 1. **GPS:** `WAKE_EVT_GPS_RUN` starts `gps_task`, which answers with
+ *    `WAKE_EVT_FIX`. Without a fix before `GPS_TIMEOUT_SEC` the cycle falls
+ *    back to a cell-location report.
+ * 2. **Filter:** runs in the orchestrator, feeds the duty-cycle policy and
+ *    decides through geofences / the report filter whether to send.
+ * 3. **Uplink:** `WAKE_EVT_UPLINK_FIX` or `WAKE_EVT_UPLINK_CELL` starts
+ *    `sim800_task`, which answers with `WAKE_EVT_UPLINK_OK` or
+ *    `WAKE_EVT_UPLINK_FAIL` before `WAKE_UPLINK_TIMEOUT_SEC`.
+ * 4. **Sleep:** powers the peripherals down, prints the phase timing and
+ *    calls `duty_cycle_sleep()` with the outcome of the cycle.
+ *
+ * Each phase runs at the CPU clock listed in `s_phase_mhz`.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "wake_cycle.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "../NEO_6M_driver/NEO_6M.h"
+#include "../sim800L_driver/sim800L_driver.h"
+#include "../fix_record/fix_record.h"
+#include "../geo/geo.h"
+#include "../duty_cycle/duty_cycle.h"
+#include "../report_filter/report_filter.h"
+#include "../geofence/geofence.h"
+#include "../rtc_clock/rtc_clock.h"
+#include "../battery/battery.h"
+#include "../task_registry/task_registry.h"
+#include "../power/power.h"
+#include "../boot_timeline/boot_timeline.h"
+#include "../energy/energy.h"
+
+/** @brief Number of event bits used (timestamps are kept per bit) */
+#define WAKE_EVT_COUNT 6
+
+// Report text built in the filter phase and sent by the SIM800 task
+char smsMessage[SMS_MESSAGE_SIZE] = { 0 };
+
+static EventGroupHandle_t s_events = NULL;
+static StaticEventGroup_t s_events_buf;
+
+// Time each event bit was last set, for the hand-off latency
+static volatile int64_t s_signal_us[WAKE_EVT_COUNT];
+
+static wake_cycle_timing_t s_timing;
+static wake_phase_t s_phase = WAKE_PHASE_BOOT;
+static int64_t s_phase_start_us = 0;
+static uint32_t s_phase_start_uah = 0;
+
+/** @brief CPU clock of each phase: fast where it computes, slow where it waits (MHz) */
+static const uint32_t s_phase_mhz[WAKE_PHASE_COUNT] = {
+	POWER_CPU_MHZ_FAST, // boot
+	POWER_CPU_MHZ_SLOW, // GPS acquiring, mostly napping between NMEA bursts
+	POWER_CPU_MHZ_FAST, // filter
+	POWER_CPU_MHZ_SLOW, // uplink, waiting on AT responses
+	POWER_CPU_MHZ_SLOW, // sleep preparation
+};
+
+static const char *const s_phase_names[WAKE_PHASE_COUNT] = { "boot", "gps",
+		"filter", "uplink", "sleep" };
+
+/**
+ * @brief Closes the timing of the current phase and switches to `next`.
+ *
+ * Passing the current phase only refreshes its timing. The charge of a
+ * phase is what the energy ledger counted while it ran. The CPU clock of
+ * the new phase is applied on entry.
+ */
+static void wake_cycle_enter(wake_phase_t next) {
+	int64_t now = esp_timer_get_time();
+	uint32_t uah = energy_wake_uah();
+
+	s_timing.phase_ms[s_phase] = (uint32_t) ((now - s_phase_start_us) / 1000);
+	s_timing.charge_uah[s_phase] = uah - s_phase_start_uah;
+	if (next != s_phase) {
+		s_phase = next;
+		s_phase_start_us = now;
+		s_phase_start_uah = uah;
+		power_set_cpu_mhz(s_phase_mhz[next]);
+	}
+}
+
+/**
+ * @brief Waits for any of `bits` until the phase deadline.
+ *
+ * The matching bits are cleared, and the delay between the worker setting
+ * the bit and this task running again is stored as the phase hand-off.
+ *
+ * @return The bits that were set, 0 on timeout.
+ */
+static EventBits_t wake_cycle_await(EventBits_t bits, uint32_t timeout_sec) {
+	EventBits_t got = xEventGroupWaitBits(s_events, bits, pdTRUE, pdFALSE,
+			pdMS_TO_TICKS(timeout_sec * 1000)) & bits;
+
+	if (got) {
+		int bit = __builtin_ctz(got);
+		s_timing.handoff_us[s_phase] = (uint32_t) (esp_timer_get_time()
+				- s_signal_us[bit]);
+	}
+	return got;
+}
+
+/**
+ * @brief Filter phase: decides whether the fix is reported and builds the SMS.
+ *
+ * Feeds the fix to the duty-cycle policy. If a geofence table is loaded,
+ * only entry/exit events (listed in the SMS) or a heartbeat trigger a
+ * report; otherwise the fix must lie beyond `REPORT_RADIUS_M` of the last
+ * report.
+ *
+ * @param fix The fix read from the shared record.
+ * @return true if `smsMessage` was prepared and should be sent.
+ */
+static bool wake_cycle_filter(const fix_record_t *fix) {
+	// Feed the fixed-point position and motion to the duty-cycle policy
+	duty_cycle_record_fix(fix->lat_e7, fix->lon_e7, fix->speed_cms,
+			fix->course_cdeg);
+
+	geofence_event_t events[WAKE_MAX_GEOFENCE_EVENTS];
+	int n_events = geofence_update(fix->lat_e7, fix->lon_e7, events,
+			WAKE_MAX_GEOFENCE_EVENTS);
+	bool report;
+	if (GEOFENCE_REPORT_ONLY_EVENTS && geofence_active())
+		report = n_events > 0 || report_filter_heartbeat_due();
+	else
+		report = report_filter_should_send(fix->lat_e7, fix->lon_e7);
+
+	if (!report)
+		return false;
+
+	int pos = snprintf(smsMessage, sizeof(smsMessage), "%.7f, %.7f",
+			(double) fix->lat_e7 / GEO_E7, (double) fix->lon_e7 / GEO_E7);
+	if (fix->utc_ms != 0 && pos > 0 && pos < (int) sizeof(smsMessage)) {
+		char utc[RTC_CLOCK_STR_SIZE];
+		rtc_clock_format(fix->utc_ms, utc, sizeof(utc));
+		pos += snprintf(smsMessage + pos, sizeof(smsMessage) - pos,
+				"\nUTC: %s", utc);
+	}
+	for (int i = 0; i < n_events && i < WAKE_MAX_GEOFENCE_EVENTS; i++) {
+		if (pos < 0 || pos >= (int) sizeof(smsMessage))
+			break;
+		pos += snprintf(smsMessage + pos, sizeof(smsMessage) - pos,
+				"\n%s %u", events[i].entered ? "Enter" : "Exit", events[i].id);
+	}
+
+	printf("SMS Message prepared: %s\n", smsMessage);
+	return true;
+}
+
+/**
+ * @brief Sleep phase: powers everything down and ends the wake cycle.
+ *
+ * The boot timeline, the phase timing, the light-sleep statistics, the
+ * energy ledger and the heap / stack headroom report are printed first, so every cycle of a
+ * profiling run logs what `host_power_model.py` and `host_task_stacks.py`
+ * read.
+ *
+ * @param outcome How the wake cycle ended. Does not return.
+ */
+static void wake_cycle_sleep(duty_cycle_outcome_t outcome) {
+	wake_cycle_enter(WAKE_PHASE_SLEEP);
+
+	gpio_set_level(GPS_gpio, 0);
+	gpio_set_level(SIM_gpio, 1);
+	energy_set(ENERGY_GPS | ENERGY_SIM | ENERGY_MODEM_TX, false);
+	battery_set_load(false);
+
+	wake_cycle_enter(WAKE_PHASE_SLEEP);
+	boot_timeline_report();
+	for (int i = 0; i < WAKE_PHASE_COUNT; i++) {
+		printf("Wake cycle: %-6s %7u ms, hand-off %6u us, %5u uAh\n",
+				s_phase_names[i], s_timing.phase_ms[i],
+				s_timing.handoff_us[i], s_timing.charge_uah[i]);
+	}
+	power_stats_t pm;
+	power_get_stats(&pm);
+	printf("Power: light sleep %u ms in %u naps (%u rx, %u timer wakes)\n",
+			pm.sleep_ms, pm.naps, pm.rx_wakes, pm.timer_wakes);
+
+	static char ledger[512];
+	energy_format(ledger, sizeof(ledger));
+	printf("%s", ledger);
+	task_registry_report();
+
+	duty_cycle_sleep(outcome);
+}
+
+/**
+ * @brief Orchestrator task running one wake cycle from GPS to deep sleep.
+ *
+ * @param arg Task argument (unused).
+ */
+static void wake_cycle_task(void *arg) {
+	fix_record_t fix;
+
+	// --- GPS: acquire a fix or time out ---
+	wake_cycle_enter(WAKE_PHASE_GPS);
+	gpio_set_level(GPS_gpio, 1); // already on since app_main entry
+	energy_set(ENERGY_GPS, true);
+	wake_cycle_signal(WAKE_EVT_GPS_RUN);
+	bool have_fix = wake_cycle_await(WAKE_EVT_FIX, GPS_TIMEOUT_SEC) != 0
+			&& fix_record_get(&fix) != 0;
+	wake_cycle_clear(WAKE_EVT_GPS_RUN);
+	gpio_set_level(GPS_gpio, 0);
+	energy_set(ENERGY_GPS, false);
+	if (have_fix)
+		printf("Wake cycle: wake-to-fix %u ms\n",
+				(uint32_t) (esp_timer_get_time() / 1000));
+
+	// --- Filter: report the fix, or fall back to cell location ---
+	EventBits_t job = WAKE_EVT_UPLINK_CELL;
+	if (have_fix) {
+		wake_cycle_enter(WAKE_PHASE_FILTER);
+		if (!wake_cycle_filter(&fix))
+			wake_cycle_sleep(DUTY_OUTCOME_SUPPRESSED);
+		job = WAKE_EVT_UPLINK_FIX;
+	} else {
+		printf("No GPS fix after %d sec, falling back to cell location...\n",
+		GPS_TIMEOUT_SEC);
+	}
+
+	// --- Uplink: hand the report to the SIM800 task ---
+	wake_cycle_enter(WAKE_PHASE_UPLINK);
+	wake_cycle_signal(job);
+	EventBits_t result = wake_cycle_await(
+			WAKE_EVT_UPLINK_OK | WAKE_EVT_UPLINK_FAIL, WAKE_UPLINK_TIMEOUT_SEC);
+
+	if (!(result & WAKE_EVT_UPLINK_OK)) {
+		if (result == 0)
+			printf("Uplink timed out after %d sec\n", WAKE_UPLINK_TIMEOUT_SEC);
+		wake_cycle_sleep(DUTY_OUTCOME_SEND_FAILED);
+	}
+	energy_note_report();
+
+	if (job == WAKE_EVT_UPLINK_CELL)
+		wake_cycle_sleep(DUTY_OUTCOME_NO_FIX);
+
+	report_filter_mark_sent(fix.lat_e7, fix.lon_e7);
+	geofence_commit();
+	wake_cycle_sleep(DUTY_OUTCOME_REPORTED);
+}
+
+/**
+ * @brief Creates the event group, the orchestrator and its worker tasks.
+ *
+ * Everything is statically allocated (tasks through the task registry, which
+ * gives the orchestrator a higher priority than its workers), so a wake
+ * cycle never depends on the heap for its own tasks.
+ */
+void wake_cycle_start(void) {
+	s_events = xEventGroupCreateStatic(&s_events_buf);
+
+	task_registry_create(TASK_ID_GPS, gps_task, NULL);
+	task_registry_create(TASK_ID_SIM800, sim800_task, NULL);
+	task_registry_create(TASK_ID_WAKE_CYCLE, wake_cycle_task, NULL);
+}
+
+/**
+ * @brief Sets event bits and timestamps them for the hand-off measurement.
+ *
+ * Task context only.
+ */
+void wake_cycle_signal(EventBits_t bits) {
+	int64_t now = esp_timer_get_time();
+
+	for (int i = 0; i < WAKE_EVT_COUNT; i++) {
+		if (bits & (1 << i))
+			s_signal_us[i] = now;
+	}
+	xEventGroupSetBits(s_events, bits);
+}
+
+/**
+ * @brief Clears event bits (e.g. to stop the GPS task).
+ */
+void wake_cycle_clear(EventBits_t bits) {
+	xEventGroupClearBits(s_events, bits);
+}
+
+/**
+ * @brief Blocks a worker task until any of `bits` is set.
+ *
+ * @param bits  Bits to wait for.
+ * @param clear true to clear the bits that were set (one-shot jobs).
+ * @return The bits that were set.
+ */
+EventBits_t wake_cycle_wait(EventBits_t bits, bool clear) {
+	return xEventGroupWaitBits(s_events, bits, clear ? pdTRUE : pdFALSE,
+	pdFALSE, portMAX_DELAY) & bits;
+}
+
+/**
+ * @brief Returns true if all of `bits` are currently set.
+ */
+bool wake_cycle_is_set(EventBits_t bits) {
+	return (xEventGroupGetBits(s_events) & bits) == bits;
+}
+
+/**
+ * @brief Copies the phase timing of the current wake cycle.
+ *
+ * The running phase is included up to now.
+ */
+void wake_cycle_get_timing(wake_cycle_timing_t *out) {
+	wake_phase_t phase = s_phase;
+	uint32_t ms = (uint32_t) ((esp_timer_get_time() - s_phase_start_us)
+			/ 1000);
+
+	*out = s_timing;
+	out->phase_ms[phase] = ms;
+	out->charge_uah[phase] = energy_wake_uah() - s_phase_start_uah;
+}
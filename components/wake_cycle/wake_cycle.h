@@ -0,0 +1,78 @@
+/**
+ * @file wake_cycle.h
+ * @author yassine hattay
+ * @brief Wake-cycle orchestrator for ESP12/ESP8266.
+ *
+ * One task owns the phases of a wake cycle and hands work to the GPS and
+ * SIM800 tasks through event-group bits:
+ * - **Boot:** reset until the orchestrator starts.
+ * - **GPS:** power the receiver and wait for a fix, up to `GPS_TIMEOUT_SEC`.
+ * - **Filter:** geofences and movement threshold decide whether to report.
+ * - **Uplink:** the SIM800 task sends the report, up to
+ *   `WAKE_UPLINK_TIMEOUT_SEC`.
+ * - **Sleep:** power everything down and deep sleep via the duty cycle.
+ *
+ * All tasks are created once at boot with static stacks. The time, hand-off
+ * latency and estimated charge of every phase are kept for tuning.
+ *
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef WAKE_CYCLE_H_
+#define WAKE_CYCLE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+/** @brief Orchestrator -> GPS task: receiver powered, read NMEA while set */
+#define WAKE_EVT_GPS_RUN     BIT0
+/** @brief GPS task -> orchestrator: a new fix was published */
+#define WAKE_EVT_FIX         BIT1
+/** @brief Orchestrator -> SIM800 task: send the fix report in `smsMessage` */
+#define WAKE_EVT_UPLINK_FIX  BIT2
+/** @brief Orchestrator -> SIM800 task: send a cell-location report */
+#define WAKE_EVT_UPLINK_CELL BIT3
+/** @brief SIM800 task -> orchestrator: report accepted by the network */
+#define WAKE_EVT_UPLINK_OK   BIT4
+/** @brief SIM800 task -> orchestrator: report could not be sent */
+#define WAKE_EVT_UPLINK_FAIL BIT5
+
+/** @brief Deadline of the uplink phase (power-on, registration, retries) */
+#define WAKE_UPLINK_TIMEOUT_SEC 300
+
+/** @brief Size of the SMS body prepared from a fix (coordinates, UTC, geofence events) */
+#define SMS_MESSAGE_SIZE 112
+
+/** @brief Maximum number of geofence events listed in one report */
+#define WAKE_MAX_GEOFENCE_EVENTS 4
+
+/** @brief Phases of a wake cycle, in order */
+typedef enum {
+	WAKE_PHASE_BOOT = 0,
+	WAKE_PHASE_GPS,
+	WAKE_PHASE_FILTER,
+	WAKE_PHASE_UPLINK,
+	WAKE_PHASE_SLEEP,
+	WAKE_PHASE_COUNT
+} wake_phase_t;
+
+/** @brief Per-phase measurements of the current wake cycle */
+typedef struct {
+	uint32_t phase_ms[WAKE_PHASE_COUNT];   ///< Time spent in each phase
+	uint32_t handoff_us[WAKE_PHASE_COUNT]; ///< Event set -> orchestrator running, for the event that ended the phase
+	uint32_t charge_uah[WAKE_PHASE_COUNT]; ///< Charge drawn in each phase, from the energy ledger
+} wake_cycle_timing_t;
+
+extern char smsMessage[SMS_MESSAGE_SIZE];
+
+void wake_cycle_start(void);
+void wake_cycle_signal(EventBits_t bits);
+void wake_cycle_clear(EventBits_t bits);
+EventBits_t wake_cycle_wait(EventBits_t bits, bool clear);
+bool wake_cycle_is_set(EventBits_t bits);
+void wake_cycle_get_timing(wake_cycle_timing_t *out);
+
+#endif /* WAKE_CYCLE_H_ */
@@ -11,8 +11,7 @@
  */
 
 #include "web.h"
-
-extern void get_logs(char *out_buffer, size_t max_len);
+#include "../energy/energy.h"
 
 /* FreeRTOS event group to signal when we are connected */
 static EventGroupHandle_t s_wifi_event_group;
@@ -124,8 +123,8 @@ void wifi_init_sta(void) {
  * @brief HTTP GET handler for serving debug logs.
  *
  * This function handles incoming HTTP GET requests for a debug endpoint.
- * It dynamically allocates a buffer, populates it with system logs obtained
- * from `get_logs()`, sets the response content type to plain text, sends
+ * It dynamically allocates a buffer, populates it with the energy ledger
+ * summary followed by the system logs obtained from `get_logs()`, sets the response content type to plain text, sends
  * the logs as the HTTP response, and then frees the allocated memory.
  *
  * @param req Pointer to the HTTP request structure.
@@ -140,7 +139,8 @@ static esp_err_t debug_get_handler(httpd_req_t *req) {
 	}
 
 	memset(response, 0, 4096);
-	get_logs(response, 4096);
+	size_t len = energy_format(response, 4096);
+	get_logs(response + len, 4096 - len);
 
 	httpd_resp_set_type(req, "text/plain");
 	httpd_resp_send(req, response, strlen(response));
@@ -154,14 +154,18 @@ static esp_err_t debug_get_handler(httpd_req_t *req) {
  * This function processes HTTP GET requests to display system logs in a web browser.
  * It constructs a complete HTML page that includes embedded CSS for styling and
  * JavaScript for auto-reloading and scrolling to the bottom of the logs.
- * The current logs are retrieved from `log_buffer` and embedded directly into the HTML.
+ * The energy ledger summary is embedded into the page head; the logs are
+ * then sent in chunks straight from the RAM log ring, without a copy.
  *
  * @param req Pointer to the HTTP request structure.
  * @return `ESP_OK` if the HTML page is successfully sent.
  */
 
 static esp_err_t log_page_get_handler(httpd_req_t *req) {
-	// Build the response HTML with current logs
+	char energy[512];
+	energy_format(energy, sizeof(energy));
+
+	// Build the page head with the energy ledger, the logs follow in place
 	char html_response[2048];
 	snprintf(html_response, sizeof(html_response),
 			"<!DOCTYPE html>"
@@ -199,13 +203,32 @@ static esp_err_t log_page_get_handler(httpd_req_t *req) {
 					"</head>"
 					"<body>"
 					"<h1>ESP8266 Logs</h1>"
-					"<pre id=\"logContent\">%s</pre>"
-					"</body>"
-					"</html>", log_buffer);
-
-	// Send the HTML response with strlen for the response length
-	httpd_resp_send(req, html_response, strlen(html_response));
-	return ESP_OK;
+					"<pre id=\"energy\">%s</pre>"
+					"<pre id=\"logContent\">", energy);
+
+	log_spans_t spans;
+	log_get_spans(&spans);
+
+	// A zero-length chunk ends the response, empty spans are skipped
+	esp_err_t err = httpd_resp_send_chunk(req, html_response,
+			strlen(html_response));
+	if (err == ESP_OK && spans.first_len > 0)
+		err = httpd_resp_send_chunk(req, spans.first, spans.first_len);
+	if (err == ESP_OK && spans.second_len > 0)
+		err = httpd_resp_send_chunk(req, spans.second, spans.second_len);
+	if (err == ESP_OK && !log_spans_intact(&spans)) {
+		static const char wrapped[] = "\n(log overwritten while sending)";
+		err = httpd_resp_send_chunk(req, wrapped, sizeof(wrapped) - 1);
+	}
+	if (err == ESP_OK) {
+		static const char tail[] = "</pre></body></html>";
+		err = httpd_resp_send_chunk(req, tail, sizeof(tail) - 1);
+	}
+	if (err == ESP_OK)
+		err = httpd_resp_send_chunk(req, NULL, 0);
+	if (err != ESP_OK)
+		printf("log_page_get_handler: send failed, error: %d\n", err);
+	return err;
 }
 
 /**
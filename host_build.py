@@ -0,0 +1,31 @@
+"""Builds firmware sources for the host and loads them with ctypes.
+
+Shared by the host_*.py tools that run firmware code on the PC: the
+sources are compiled with -DTEST_ON_PC=1 into a shared library, which
+swaps the SDK calls for the components' host stand-ins.
+"""
+import ctypes
+import os
+import subprocess
+import tempfile
+
+# ==============================
+# CONFIGURATION
+# ==============================
+REPO_DIR = os.path.dirname(os.path.abspath(__file__))
+CFLAGS = ["-O2", "-shared", "-fPIC", "-DTEST_ON_PC=1"]
+# ==============================
+
+
+def build_firmware(name, sources, defines=None):
+    """Compiles `sources` (paths relative to the repo) into lib<name>.so.
+
+    `defines` maps extra macros to their values. Returns the ctypes.CDLL,
+    argtypes and restypes are left to the caller.
+    """
+    out = os.path.join(tempfile.mkdtemp(), f"lib{name}.so")
+    cmd = ["gcc"] + CFLAGS + ["-o", out]
+    cmd += [f"-D{macro}={value}" for macro, value in (defines or {}).items()]
+    cmd += [os.path.join(REPO_DIR, src) for src in sources]
+    subprocess.check_call(cmd)
+    return ctypes.CDLL(out)
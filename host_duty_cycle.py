@@ -0,0 +1,215 @@
+import argparse
+import ctypes
+import math
+import random
+import sys
+
+from host_build import build_firmware
+
+# ==============================
+# CONFIGURATION
+# ==============================
+POLICY_SOURCES = ["components/duty_cycle/duty_cycle.c", "components/geo/geo.c",
+                  "components/report_filter/report_filter.c"]
+
+BATTERY_MAH = 2000
+SIM_DAYS = 30
+
+# Average currents (mA) and durations (s) of one wake cycle
+I_SLEEP = 0.10          # ESP deep sleep + regulator quiescent
+I_ESP = 70.0            # CPU active
+I_GPS = 45.0            # NEO-6M acquiring
+I_SIM = 80.0            # SIM800L boot + registration + SMS, averaged
+T_BOOT = 3.5            # boot + app_main start-up delay
+T_GPS_FIX = 35.0        # typical acquisition with a warm receiver
+T_GPS_TIMEOUT = 1000.0  # GPS_TIMEOUT_SEC
+T_SIM = 30.0            # SIM session for one SMS
+
+# Outcomes, must match duty_cycle_outcome_t
+REPORTED, NO_FIX, SEND_FAILED, SUPPRESSED = 0, 1, 2, 3
+
+SPEED_MPS = 11.0        # ~40 km/h while moving
+# ==============================
+
+
+def schedule_commuter(t):
+    h = (t / 3600.0) % 24
+    weekday = int(t // 86400) % 7 < 5
+    moving = weekday and (7.5 <= h < 8.5 or 17.5 <= h < 18.5)
+    return moving, True, 18, 0.02
+
+
+def schedule_parked(t):
+    return False, True, 18, 0.02
+
+
+def schedule_delivery(t):
+    h = (t / 3600.0) % 24
+    return 8 <= h < 17, True, 12 + int(6 * math.sin(t / 5000.0)), 0.05
+
+
+def schedule_garage(t):
+    return False, False, 10, 0.05
+
+
+def schedule_fringe(t):
+    moving, sky, _, _ = schedule_commuter(t)
+    return moving, sky, 5, 0.30
+
+
+# Each scenario returns (moving, sky visible, CSQ, SMS failure probability)
+SCENARIOS = {
+    "parked": schedule_parked,
+    "commuter": schedule_commuter,
+    "delivery": schedule_delivery,
+    "garage": schedule_garage,
+    "fringe": schedule_fringe,
+}
+
+
+def build_policy():
+    """Compiles the firmware policy for the host and loads it with ctypes."""
+    lib = build_firmware("duty_cycle", POLICY_SOURCES)
+    lib.duty_cycle_record_fix.argtypes = [ctypes.c_int32] * 4
+    lib.duty_cycle_record_signal.argtypes = [ctypes.c_int]
+    lib.duty_cycle_next_sleep_sec.argtypes = [ctypes.c_int, ctypes.c_uint32]
+    lib.duty_cycle_next_sleep_sec.restype = ctypes.c_uint32
+    lib.report_filter_should_send.argtypes = [ctypes.c_int32, ctypes.c_int32]
+    lib.report_filter_should_send.restype = ctypes.c_bool
+    lib.report_filter_mark_sent.argtypes = [ctypes.c_int32, ctypes.c_int32]
+    lib.report_filter_note_elapsed.argtypes = [ctypes.c_uint32]
+    return lib
+
+
+class AdaptivePolicy:
+    name = "adaptive"
+
+    def __init__(self, lib):
+        self.lib = lib
+        lib.duty_cycle_reset()
+        lib.report_filter_reset()
+
+    def fix(self, lat_e7, lon_e7, speed_cms, course_cdeg):
+        self.lib.duty_cycle_record_fix(lat_e7, lon_e7, speed_cms, course_cdeg)
+        return self.lib.report_filter_should_send(lat_e7, lon_e7)
+
+    def sent(self, lat_e7, lon_e7):
+        self.lib.report_filter_mark_sent(lat_e7, lon_e7)
+
+    def elapsed(self, sec):
+        self.lib.report_filter_note_elapsed(int(sec))
+
+    def signal(self, csq):
+        self.lib.duty_cycle_record_signal(csq)
+
+    def next_sleep(self, outcome, battery_mv):
+        return self.lib.duty_cycle_next_sleep_sec(outcome, battery_mv)
+
+
+class FixedPolicy:
+    """The original hardcoded intervals of sim800L_driver.c / NEO_6M.h."""
+    name = "fixed"
+
+    def fix(self, lat_e7, lon_e7, speed_cms, course_cdeg):
+        return True
+
+    def sent(self, lat_e7, lon_e7):
+        pass
+
+    def elapsed(self, sec):
+        pass
+
+    def signal(self, csq):
+        pass
+
+    def next_sleep(self, outcome, battery_mv):
+        return {REPORTED: 10, NO_FIX: 300, SEND_FAILED: 10}[outcome]
+
+
+def simulate(policy, schedule, days, capacity_mah, rng):
+    t = 0.0
+    used_mah = 0.0
+    reports = 0
+    lat, lon = 36.3810123, 9.5055585
+    heading = 0.0
+
+    while t < days * 86400:
+        soc = max(0.0, 1.0 - used_mah / capacity_mah)
+        if soc == 0.0:
+            break
+        battery_mv = int(3300 + 900 * soc)
+        moving, sky, csq, fail_p = schedule(t)
+
+        awake = T_BOOT
+        charge = I_ESP * T_BOOT
+
+        lat_e7, lon_e7 = int(lat * 1e7), int(lon * 1e7)
+        send = True
+        if sky:
+            awake += T_GPS_FIX
+            charge += (I_ESP + I_GPS) * T_GPS_FIX
+            speed_cms = int(SPEED_MPS * 100) if moving else 0
+            course_cdeg = int(math.degrees(heading) % 360 * 100) if moving else -1
+            send = policy.fix(lat_e7, lon_e7, speed_cms, course_cdeg)
+        else:
+            awake += T_GPS_TIMEOUT
+            charge += (I_ESP + I_GPS) * T_GPS_TIMEOUT
+
+        if not send:
+            outcome = SUPPRESSED
+        else:
+            # Both a fix report and the cell-location fallback use one SIM session
+            awake += T_SIM
+            charge += (I_ESP + I_SIM) * T_SIM
+            policy.signal(csq)
+            if rng.random() < fail_p:
+                outcome = SEND_FAILED
+            else:
+                outcome = REPORTED if sky else NO_FIX
+                reports += 1
+                if sky:
+                    policy.sent(lat_e7, lon_e7)
+
+        sleep_sec = policy.next_sleep(outcome, battery_mv)
+        policy.elapsed(awake + sleep_sec)
+        charge += I_SLEEP * sleep_sec
+        used_mah += charge / 3600.0
+
+        # Advance the simulated vehicle over the whole cycle
+        step = awake + sleep_sec
+        if moving:
+            heading += rng.uniform(-0.5, 0.5)
+            d = SPEED_MPS * step
+            lat += d * math.cos(heading) / 111319.0
+            lon += d * math.sin(heading) / (111319.0 * math.cos(math.radians(lat)))
+        t += step
+
+    days_run = t / 86400
+    life = days_run if used_mah >= capacity_mah else days_run * capacity_mah / max(used_mah, 1e-9)
+    return life, reports / max(days_run, 1e-9)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Replay multi-day scenarios against the duty-cycle policy")
+    parser.add_argument("--scenario", choices=SCENARIOS, action="append",
+                        help="scenario to run (default: all)")
+    parser.add_argument("--days", type=float, default=SIM_DAYS)
+    parser.add_argument("--capacity", type=float, default=BATTERY_MAH,
+                        help="battery capacity in mAh")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    lib = build_policy()
+    names = args.scenario or list(SCENARIOS)
+
+    print("scenario    policy      life(days)  reports/day")
+    for name in names:
+        for policy in (FixedPolicy(), AdaptivePolicy(lib)):
+            life, per_day = simulate(policy, SCENARIOS[name], args.days,
+                                     args.capacity, random.Random(args.seed))
+            print(f"{name:<11} {policy.name:<11} {life:>10.1f} {per_day:>12.1f}")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,94 @@
+import argparse
+import json
+import math
+import struct
+import sys
+
+# ==============================
+# CONFIGURATION
+# ==============================
+# Must match components/geofence/geofence.h and partitions.csv
+GEOFENCE_MAGIC = 0x434E4647
+GEOFENCE_VERSION = 1
+GEOFENCE_CIRCLE = 1
+GEOFENCE_POLYGON = 2
+PARTITION_OFFSET = 0x100000
+PARTITION_SIZE = 0x4000
+
+M_PER_DEG = 111319.0
+# ==============================
+
+# Example input (coordinates in decimal degrees):
+# {
+#   "fences": [
+#     {"id": 1, "circle": {"lat": 36.381012, "lon": 9.505558, "radius_m": 200}},
+#     {"id": 2, "polygon": [[36.38, 9.50], [36.39, 9.50], [36.39, 9.51], [36.38, 9.51]]}
+#   ]
+# }
+
+
+def e7(deg):
+    return int(round(deg * 1e7))
+
+
+def circle_record(fence):
+    c = fence["circle"]
+    radius = float(c["radius_m"])
+    dlat = radius / M_PER_DEG
+    dlon = radius / (M_PER_DEG * max(math.cos(math.radians(c["lat"])), 1e-6))
+    header = struct.pack("<BBHIiiii", GEOFENCE_CIRCLE, fence["id"], 1,
+                         int(math.ceil(radius)),
+                         e7(c["lat"] - dlat), e7(c["lon"] - dlon),
+                         e7(c["lat"] + dlat), e7(c["lon"] + dlon))
+    return header + struct.pack("<ii", e7(c["lat"]), e7(c["lon"]))
+
+
+def polygon_record(fence):
+    pts = fence["polygon"]
+    if len(pts) < 3:
+        raise ValueError(f"fence {fence['id']}: a polygon needs at least 3 vertices")
+    lats = [p[0] for p in pts]
+    lons = [p[1] for p in pts]
+    header = struct.pack("<BBHIiiii", GEOFENCE_POLYGON, fence["id"], len(pts), 0,
+                         e7(min(lats)), e7(min(lons)), e7(max(lats)), e7(max(lons)))
+    return header + b"".join(struct.pack("<ii", e7(lat), e7(lon)) for lat, lon in pts)
+
+
+def build_table(fences):
+    body = b""
+    for fence in fences:
+        if "circle" in fence:
+            body += circle_record(fence)
+        elif "polygon" in fence:
+            body += polygon_record(fence)
+        else:
+            raise ValueError(f"fence {fence.get('id')}: needs 'circle' or 'polygon'")
+    return struct.pack("<IHH", GEOFENCE_MAGIC, GEOFENCE_VERSION, len(fences)) + body
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Build the binary geofence table for the 'geofence' partition")
+    parser.add_argument("input", help="JSON file describing the fences")
+    parser.add_argument("-o", "--output", default="geofence.bin")
+    args = parser.parse_args()
+
+    with open(args.input) as f:
+        fences = json.load(f)["fences"]
+    if len(fences) > 32:
+        print(f"[GEOFENCE] Warning: only the first 32 of {len(fences)} fences are tracked")
+
+    table = build_table(fences)
+    if len(table) > PARTITION_SIZE:
+        print(f"[GEOFENCE] Table is {len(table)} bytes, partition holds {PARTITION_SIZE}")
+        return 1
+
+    with open(args.output, "wb") as f:
+        f.write(table)
+    print(f"[GEOFENCE] {len(fences)} fences, {len(table)} bytes written to {args.output}")
+    print(f"[GEOFENCE] Flash with: esptool.py write_flash 0x{PARTITION_OFFSET:X} {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
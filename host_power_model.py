@@ -0,0 +1,128 @@
+import argparse
+import re
+import sys
+
+# ==============================
+# CONFIGURATION
+# ==============================
+# ESP-side supply current (mA)
+I_ESP_160 = 70.0        # CPU active at 160 MHz, ENERGY_I_ESP_FAST_UA
+I_ESP_80 = 56.0         # CPU active at 80 MHz, ENERGY_I_ESP_SLOW_UA
+I_ESP_LIGHT = 1.0       # light sleep, ENERGY_I_ESP_LIGHT_UA
+
+# CPU clock of each wake-cycle phase, s_phase_mhz in wake_cycle.c
+PHASE_MHZ = {"boot": 160, "gps": 80, "filter": 160, "uplink": 80, "sleep": 80}
+
+# GPS line and nap parameters, see NEO_6M.h and power.h
+GPS_BAUD = 9600
+NMEA_PERIOD_MS = 1000   # GPS_NMEA_PERIOD_MS
+RX_IDLE_MS = 20         # POWER_RX_IDLE_MS
+NAP_MIN_MS = 30         # POWER_NAP_MIN_MS
+NAP_GUARD_MS = 30       # POWER_NAP_GUARD_MS
+WAKE_LATENCY_MS = 5     # light-sleep exit, clocks back up
+ECHO_PREFIX = len("GPS line: \n")
+
+# Bytes per second of the NEO-6M output (line lengths of a typical fix)
+NMEA_DEFAULT = [75, 70, 35, 60, 70, 70, 70, 50]   # GGA RMC VTG GSA 3xGSV GLL
+NMEA_RMC_ONLY = [70]
+# ==============================
+
+PHASE_RE = re.compile(r"Wake cycle:\s+(\w+)\s+(\d+) ms")
+POWER_RE = re.compile(r"Power: light sleep (\d+) ms in (\d+) naps")
+
+
+def current(mhz):
+    return I_ESP_160 if mhz >= 160 else I_ESP_80
+
+
+def nap_fraction(lines):
+    """Share of every NMEA period the GPS task can spend in light sleep."""
+    char_ms = 10000.0 / GPS_BAUD
+    burst_ms = sum(lines) * char_ms
+    # The console shares UART0 at the same speed: each line is echoed once
+    # received, and the nap waits for the echo of the last one to drain
+    echo_ms = sum(n + ECHO_PREFIX for n in lines) * char_ms
+    tail_ms = max(echo_ms - burst_ms, (lines[-1] + ECHO_PREFIX) * char_ms)
+    awake_ms = burst_ms + tail_ms + RX_IDLE_MS + NAP_GUARD_MS + WAKE_LATENCY_MS
+    nap_ms = NMEA_PERIOD_MS - awake_ms
+    return nap_ms / NMEA_PERIOD_MS if nap_ms >= NAP_MIN_MS else 0.0
+
+
+def esp_mah(phases, nap_ms, managed):
+    """ESP-side charge of one wake cycle, with or without power management."""
+    uah = 0.0
+    for name, ms in phases.items():
+        if not managed:
+            uah += ms * I_ESP_160 / 3600.0
+            continue
+        asleep = min(nap_ms, ms) if name == "gps" else 0
+        uah += (ms - asleep) * current(PHASE_MHZ.get(name, 160)) / 3600.0
+        uah += asleep * I_ESP_LIGHT / 3600.0
+    return uah / 1000.0
+
+
+def read_logs(paths):
+    """Returns one (phases, nap_ms) per wake cycle found in the monitor logs."""
+    cycles, phases = [], {}
+    for path in paths:
+        with open(path, errors="replace") as f:
+            for line in f:
+                m = PHASE_RE.search(line)
+                if m:
+                    phases[m.group(1)] = int(m.group(2))
+                    continue
+                m = POWER_RE.search(line)
+                if m and phases:
+                    cycles.append((phases, int(m.group(1))))
+                    phases = {}
+    return cycles
+
+
+def report(label, phases, nap_ms):
+    before = esp_mah(phases, 0, False)
+    after = esp_mah(phases, nap_ms, True)
+    gps_ms = phases.get("gps", 0)
+    share = 100.0 * nap_ms / gps_ms if gps_ms else 0.0
+    print(f"[POWER] {label:<18} gps {gps_ms / 1000.0:7.1f} s, asleep {share:5.1f} %, "
+          f"ESP {before:7.3f} -> {after:7.3f} mAh ({before / after if after else 0:4.1f}x)")
+    return before, after
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Estimate the ESP-side saving of light sleep and clock scaling")
+    parser.add_argument("logs", nargs="*",
+                        help="serial monitor logs with 'Wake cycle:' and 'Power:' lines")
+    parser.add_argument("--gps-sec", type=float, action="append",
+                        help="model a GPS phase of this length (repeatable)")
+    args = parser.parse_args()
+
+    if args.logs:
+        cycles = read_logs(args.logs)
+        if not cycles:
+            print("[POWER] No complete wake cycle in the logs")
+            return 1
+        total_before = total_after = 0.0
+        for i, (phases, nap_ms) in enumerate(cycles):
+            before, after = report(f"cycle {i + 1}", phases, nap_ms)
+            total_before += before
+            total_after += after
+        print(f"[POWER] {len(cycles)} cycles: ESP {total_before:.3f} -> "
+              f"{total_after:.3f} mAh")
+        return 0
+
+    # No logs: model typical cycles from the NMEA output and the nap timing
+    phases = {"boot": 300, "filter": 20, "uplink": 30000, "sleep": 50}
+    for lines, label in ((NMEA_DEFAULT, "all NMEA"), (NMEA_RMC_ONLY, "RMC only")):
+        frac = nap_fraction(lines)
+        print(f"[POWER] {label}: {sum(lines)} bytes/s, asleep {100 * frac:.1f} % "
+              f"of the GPS phase, ESP {I_ESP_160:.0f} -> "
+              f"{(1 - frac) * I_ESP_80 + frac * I_ESP_LIGHT:.1f} mA while acquiring")
+        for gps_sec in args.gps_sec or [35.0, 300.0, 1000.0]:
+            cycle = dict(phases, gps=int(gps_sec * 1000))
+            report(f"{label}, {gps_sec:.0f} s", cycle, int(gps_sec * 1000 * frac))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
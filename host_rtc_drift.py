@@ -0,0 +1,168 @@
+import argparse
+import ctypes
+import math
+import random
+import sys
+
+from host_build import build_firmware
+
+# ==============================
+# CONFIGURATION
+# ==============================
+CLOCK_SOURCES = ["components/rtc_clock/rtc_clock.c"]
+
+START_UTC_MS = 1792281600000  # 2026-10-18 00:00:00 UTC
+SIM_DAYS = 7
+
+T_FIX_MIN = 20.0      # GPS time-to-fix after boot (s)
+T_FIX_MAX = 45.0
+T_AFTER_FIX = 15.0    # SMS session etc. before sleeping (s)
+WARMUP_CYCLES = 8     # cycles ignored while the drift estimate converges
+
+# Must match s_align_sec / RTC_CLOCK_MIN_ALIGN_SEC in rtc_clock.c
+ALIGN_SEC = [3600, 1800, 900, 600, 300, 60]
+MIN_ALIGN_SEC = 60
+# ==============================
+
+
+def profile_constant(t):
+    return 30000
+
+
+def profile_daily(t):
+    # Slow-clock drift swinging with the day/night temperature cycle
+    return int(20000 + 15000 * math.sin(2 * math.pi * t / 86400.0))
+
+
+def profile_step(t):
+    # Tracker moved from a cold garage into a hot car every 12 hours
+    return -10000 if int(t // 43200) % 2 == 0 else 40000
+
+
+def profile_walk(t, _hourly=[]):
+    # Random walk of the drift, one step per hour (same path on every run)
+    hour = int(t // 3600)
+    if not _hourly:
+        rng = random.Random(7)
+        ppm = 20000.0
+        for _ in range(24 * 366):
+            _hourly.append(int(ppm))
+            ppm = min(max(ppm + rng.gauss(0, 200.0), -50000.0), 80000.0)
+    return _hourly[min(hour, len(_hourly) - 1)]
+
+
+# Each profile returns the true drift (ppm) of the RTC slow clock at time t (s)
+PROFILES = {
+    "constant": profile_constant,
+    "daily": profile_daily,
+    "step": profile_step,
+    "walk": profile_walk,
+}
+
+
+def build_clock():
+    """Compiles the firmware clock for the host and loads it with ctypes."""
+    lib = build_firmware("rtc_clock", CLOCK_SOURCES)
+    lib.rtc_clock_init.argtypes = [ctypes.c_bool]
+    lib.rtc_clock_sync.argtypes = [ctypes.c_uint64]
+    lib.rtc_clock_prepare_sleep.argtypes = [ctypes.c_uint32]
+    lib.rtc_clock_schedule_ms.argtypes = [ctypes.c_uint32]
+    lib.rtc_clock_schedule_ms.restype = ctypes.c_uint32
+    lib.rtc_clock_drift_ppm.restype = ctypes.c_int32
+    lib.rtc_clock_host_set_uptime_ms.argtypes = [ctypes.c_uint64]
+    return lib
+
+
+def align_period_ms(sleep_sec):
+    for period in ALIGN_SEC:
+        if period <= sleep_sec:
+            return period * 1000
+    return MIN_ALIGN_SEC * 1000
+
+
+def simulate(lib, profile, sleep_sec, days, gps_p, calibrated, rng):
+    """Runs wake cycles against the true drift and returns wake-up errors (ms).
+
+    The error of a wake-up is its distance from the nearest wall-clock
+    boundary the schedule aims for. Uncalibrated runs request the nominal
+    sleep like the original firmware.
+    """
+    lib.rtc_clock_reset()
+    lib.rtc_clock_host_set_uptime_ms(0)
+    lib.rtc_clock_init(False)
+
+    period = align_period_ms(sleep_sec)
+    real_ms = START_UTC_MS + rng.randrange(period)
+    end_ms = real_ms + int(days * 86400000)
+    errors = []
+    drifts = []
+    cycle = 0
+
+    while real_ms < end_ms:
+        if cycle > 0:
+            lib.rtc_clock_host_set_uptime_ms(0)
+            lib.rtc_clock_init(True)
+            if cycle > WARMUP_CYCLES:
+                offset = (real_ms + period // 2) % period - period // 2
+                errors.append(offset)
+
+        fix_ms = int(rng.uniform(T_FIX_MIN, T_FIX_MAX) * 1000)
+        if rng.random() < gps_p:
+            lib.rtc_clock_host_set_uptime_ms(fix_ms)
+            lib.rtc_clock_sync(real_ms + fix_ms)
+
+        awake_ms = fix_ms + int(T_AFTER_FIX * 1000)
+        lib.rtc_clock_host_set_uptime_ms(awake_ms)
+        if calibrated:
+            timer_ms = lib.rtc_clock_schedule_ms(sleep_sec)
+        else:
+            timer_ms = sleep_sec * 1000
+        lib.rtc_clock_prepare_sleep(timer_ms)
+
+        true_ppm = profile((real_ms - START_UTC_MS) / 1000.0)
+        drifts.append(true_ppm - lib.rtc_clock_drift_ppm())
+        real_ms += awake_ms + int(timer_ms * (1 + true_ppm / 1e6))
+        cycle += 1
+
+    return errors, drifts
+
+
+def summary(values):
+    if not values:
+        return 0.0, 0.0
+    return (sum(abs(v) for v in values) / len(values),
+            max(abs(v) for v in values))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Replay synthetic RTC drift profiles against rtc_clock.c")
+    parser.add_argument("--profile", choices=PROFILES, action="append",
+                        help="drift profile to run (default: all)")
+    parser.add_argument("--sleep", type=int, action="append",
+                        help="nominal sleep in seconds (default: 120 and 3600)")
+    parser.add_argument("--days", type=float, default=SIM_DAYS)
+    parser.add_argument("--gps", type=float, default=0.9,
+                        help="probability that a wake gets GPS time")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    lib = build_clock()
+    names = args.profile or list(PROFILES)
+    sleeps = args.sleep or [120, 3600]
+
+    print("profile   sleep(s)  mode          mean|err|(s)  max|err|(s)  mean|drift err|(ppm)")
+    for name in names:
+        for sleep_sec in sleeps:
+            for calibrated in (False, True):
+                errors, drifts = simulate(lib, PROFILES[name], sleep_sec, args.days,
+                                          args.gps, calibrated, random.Random(args.seed))
+                mean_err, max_err = summary(errors)
+                mean_drift, _ = summary(drifts[WARMUP_CYCLES:])
+                mode = "calibrated" if calibrated else "uncorrected"
+                print(f"{name:<9} {sleep_sec:>8}  {mode:<12} {mean_err / 1000:>13.2f}"
+                      f" {max_err / 1000:>12.2f} {mean_drift:>21.0f}")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,313 @@
+import argparse
+import ctypes
+import os
+import pty
+import select
+import sys
+import threading
+import time
+import tty
+
+from host_build import build_firmware
+
+
+# ==============================
+# CONFIGURATION
+# ==============================
+# Scenarios model the modem behaviours the SIM800 driver has to cope with.
+#   latency      : delay before every response (seconds)
+#   reg_delay    : time after power-on/reset before +CREG reports registered
+#   cms_errors   : number of +CMGS attempts answered with +CMS ERROR
+#   urc_interval : period of unsolicited result codes (0 = never)
+SCENARIOS = {
+    "nominal":   {"latency": 0.02, "reg_delay": 2.0,  "cms_errors": 0, "urc_interval": 0},
+    "slow":      {"latency": 0.50, "reg_delay": 2.0,  "cms_errors": 0, "urc_interval": 0},
+    "late_reg":  {"latency": 0.02, "reg_delay": 18.0, "cms_errors": 0, "urc_interval": 0},
+    "cms_error": {"latency": 0.02, "reg_delay": 2.0,  "cms_errors": 2, "urc_interval": 0},
+    "urc_storm": {"latency": 0.02, "reg_delay": 2.0,  "cms_errors": 0, "urc_interval": 0.3},
+}
+
+URCS = [b"\r\nRING\r\n", b"\r\n+CMTI: \"SM\",1\r\n", b"\r\n+CREG: 1\r\n"]
+
+CENG_REPLY = (b"\r\n+CENG: 1,1\r\n\r\n"
+              b"+CENG: 0,\"0030,45,00,605,02,27,2b3c,00,05,1f4a,255\"\r\n"
+              b"+CENG: 1,\"0023,30,14,2b3d,605,02,1f4a\"\r\n"
+              b"+CENG: 2,\"0041,27,11,2b41,605,02,1f4a\"\r\n"
+              b"+CENG: 3,\"0052,22,09,3c07,605,02,1f4b\"\r\n"
+              b"+CENG: 4,\"0017,19,21,3c0a,605,02,1f4b\"\r\n"
+              b"+CENG: 5,\"0066,15,05,2b52,605,02,1f4a\"\r\n"
+              b"+CENG: 6,\"0000,00,00,0000,000,00,0000\"\r\n\r\nOK\r\n")
+CLBS_REPLY = b"\r\n+CLBS: 0,9.505558,36.381012,550\r\n\r\nOK\r\n"
+
+# Driver built for the host and bound to the pty (not with --port)
+SIM800_SOURCES = ["components/sim800L_driver/sim800L_driver.c",
+                  "components/sim800L_driver/sim800L_driver_tests.c",
+                  "components/transport/transport.c",
+                  "components/rtc_clock/rtc_clock.c",
+                  "components/duty_cycle/duty_cycle.c", "components/geo/geo.c",
+                  "components/report_filter/report_filter.c"]
+
+# Fix report as the wake-cycle orchestrator prepares it (smsMessage)
+FIX_MESSAGE = ("36.3810124, 9.5055585\nUTC: 2026-10-18 12:34:56"
+               "\nEnter 1\nExit 2\nEnter 3\nExit 4")
+BATTERY_MV = 3712
+BATTERY_SAG_MV = 184
+
+BENCH_COUNT = 3        # SMS per scenario with --bench
+BENCH_TIMEOUT_S = 240  # --bench default for --timeout
+# ==============================
+
+
+class FakeSim800:
+    """AT-command model of the SIM800L subset used by sim800L_driver.c.
+
+    A session starts with the first byte the driver sends and ends when an
+    SMS is accepted, so its duration is the driver's wall time per SMS
+    including registration polling, retries and fixed delays.
+    """
+
+    def __init__(self, fd, scenario, verbose):
+        self.fd = fd
+        self.cfg = scenario
+        self.verbose = verbose
+        self.rx = b""
+        self.sms_mode = False
+        self.sms_text = b""
+        self.sessions = []
+        self.session_start = None
+        self.next_urc = None
+        self.power_on()
+
+    def power_on(self):
+        self.echo = True
+        self.boot_time = time.monotonic()
+        self.cms_left = self.cfg["cms_errors"]
+        if self.cfg["urc_interval"]:
+            self.next_urc = self.boot_time + self.cfg["urc_interval"]
+
+    def registered(self):
+        return time.monotonic() - self.boot_time >= self.cfg["reg_delay"]
+
+    def send(self, data):
+        time.sleep(self.cfg["latency"])
+        os.write(self.fd, data)
+        if self.verbose:
+            print(f"  <- {data!r}")
+
+    def tick(self):
+        now = time.monotonic()
+        if self.next_urc is not None and now >= self.next_urc:
+            os.write(self.fd, URCS[int(now) % len(URCS)])
+            self.next_urc = now + self.cfg["urc_interval"]
+
+    def feed(self, data):
+        if self.session_start is None:
+            self.session_start = time.monotonic()
+        self.rx += data
+
+        if self.sms_mode:
+            if b"\x1a" in self.rx:
+                text, _, self.rx = self.rx.partition(b"\x1a")
+                self.sms_mode = False
+                self.finish_sms((self.sms_text + text).lstrip(b"\r\n"))
+                self.sms_text = b""
+            return
+
+        while b"\r" in self.rx or b"\n" in self.rx:
+            idx = min(i for i in (self.rx.find(b"\r"), self.rx.find(b"\n")) if i >= 0)
+            line, self.rx = self.rx[:idx], self.rx[idx + 1:]
+            line = line.strip()
+            if line:
+                self.command(line.decode(errors="replace"))
+            if self.sms_mode:
+                self.sms_text, self.rx = self.rx, b""
+                return
+
+    def command(self, cmd):
+        if self.verbose:
+            print(f"  -> {cmd}")
+        if self.echo:
+            os.write(self.fd, cmd.encode() + b"\r")
+
+        up = cmd.upper()
+        if up == "ATE0":
+            self.echo = False
+            self.send(b"\r\nOK\r\n")
+        elif up == "AT+CREG?":
+            stat = 1 if self.registered() else 2
+            self.send(b"\r\n+CREG: 0,%d\r\n\r\nOK\r\n" % stat)
+        elif up.startswith("AT+CFUN=1,1"):
+            self.send(b"\r\nOK\r\n")
+            self.power_on()
+        elif up.startswith("AT+CMGS="):
+            self.sms_mode = True
+            self.send(b"\r\n> ")
+        elif up == "AT+CENG?":
+            self.send(CENG_REPLY)
+        elif up.startswith("AT+CLBS"):
+            self.send(CLBS_REPLY)
+        elif up.startswith("AT"):
+            self.send(b"\r\nOK\r\n")
+        else:
+            self.send(b"\r\nERROR\r\n")
+
+    def finish_sms(self, text):
+        if self.cms_left > 0:
+            self.cms_left -= 1
+            self.send(b"\r\n+CMS ERROR: 500\r\n")
+            return
+
+        self.send(b"\r\n+CMGS: %d\r\n\r\nOK\r\n" % (len(self.sessions) + 1))
+        elapsed = time.monotonic() - self.session_start
+        self.sessions.append(elapsed)
+        self.session_start = None
+        print(f"[SIM800] SMS #{len(self.sessions)} in {elapsed:.3f} s: "
+              f"{text.decode(errors='replace')!r}")
+
+
+def build_driver():
+    """Compiles the SIM800 driver for the host and loads it with ctypes."""
+    lib = build_firmware("sim800", SIM800_SOURCES)
+    lib.sim800_host_uplink.argtypes = [ctypes.c_int, ctypes.c_bool]
+    lib.sim800_host_uplink.restype = ctypes.c_bool
+    lib.sim_set_fix.argtypes = [ctypes.c_char_p]
+    lib.sim_set_battery.argtypes = [ctypes.c_uint32, ctypes.c_uint32]
+    lib.rtc_clock_init.argtypes = [ctypes.c_bool]
+    lib.rtc_clock_sync.argtypes = [ctypes.c_uint64]
+    lib.rtc_clock_init(False)
+    lib.sim_set_fix(FIX_MESSAGE.encode())
+    lib.sim_set_battery(BATTERY_MV, BATTERY_SAG_MV)
+    return lib
+
+
+def open_link(port, baud):
+    """Returns (fd, description, peer fd or handle to keep open) for a pty
+    or serial port."""
+    if port:
+        import serial  # pyserial, only needed when talking to real hardware
+        ser = serial.Serial(port, baud, timeout=0)
+        return ser.fileno(), port, ser
+    master, slave = pty.openpty()
+    tty.setraw(slave)
+    return master, os.ttyname(slave), slave
+
+
+class Driver(threading.Thread):
+    """One uplink job of the host-built driver, on the slave side of the pty.
+
+    ctypes releases the GIL during the call, so the modem keeps answering.
+    """
+
+    def __init__(self, lib, fd, cell):
+        super().__init__(daemon=True)
+        self.lib, self.fd, self.cell = lib, fd, cell
+        self.sent = None
+        self.start_time = time.monotonic()
+
+    def run(self):
+        self.lib.rtc_clock_sync(int(time.time() * 1000))
+        self.sent = self.lib.sim800_host_uplink(self.fd, self.cell)
+        ctypes.CDLL(None).fflush(None)  # driver printf output
+
+
+def run_scenario(name, args, lib):
+    """Runs the fake modem until `args.count` SMS (with the host driver:
+    uplink jobs) are done. Returns (SMS durations, uplink results)."""
+    fd, where, peer = open_link(args.port, args.baud)
+    print(f"[SIM800] Scenario '{name}' {SCENARIOS[name]} on {where}")
+    modem = FakeSim800(fd, SCENARIOS[name], args.verbose)
+    driver = None
+    uplinks = []
+
+    def done():
+        n = len(uplinks) if lib else len(modem.sessions)
+        return args.count != 0 and n >= args.count
+
+    deadline = time.monotonic() + args.timeout if args.timeout else None
+    try:
+        while not done():
+            if lib and (driver is None or not driver.is_alive()):
+                if driver is not None:
+                    uplinks.append(driver.sent)
+                    print(f"[SIM800] Uplink {'sent' if driver.sent else 'FAILED'}"
+                          f" after {time.monotonic() - driver.start_time:.3f} s")
+                    if done():
+                        break
+                modem.power_on()  # the board powers the module for each job
+                driver = Driver(lib, peer, args.cell)
+                driver.start()
+                if args.timeout:
+                    deadline = time.monotonic() + args.timeout
+            if deadline and time.monotonic() > deadline:
+                print("[SIM800] Scenario timed out")
+                break
+            ready, _, _ = select.select([fd], [], [], 0.05)
+            if ready:
+                n_sessions = len(modem.sessions)
+                modem.feed(os.read(fd, 1024))
+                if not lib and args.timeout and len(modem.sessions) > n_sessions:
+                    deadline = time.monotonic() + args.timeout
+            modem.tick()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if args.port:
+            peer.close()
+        else:
+            os.close(fd)  # a driver still running sees a hung-up line
+            if driver is not None and driver.is_alive():
+                driver.join()
+            os.close(peer)
+    return modem.sessions, uplinks
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Fake SIM800L modem and per-SMS latency benchmark of "
+        "sim800L_driver.c, built for the host on a pty or the tracker on "
+        "a serial port")
+    parser.add_argument("--scenario", choices=SCENARIOS, default="nominal")
+    parser.add_argument("--bench", action="store_true",
+                        help="run every scenario in turn and print a summary")
+    parser.add_argument("--port", help="serial port wired to the tracker "
+                        "(default: create a pty and run the driver on the host)")
+    parser.add_argument("--baud", type=int, default=9600)
+    parser.add_argument("--cell", action="store_true",
+                        help="host driver sends the cell report instead of the fix")
+    parser.add_argument("--count", type=int, default=0,
+                        help="SMS to wait for per scenario (0 = until Ctrl+C, "
+                        f"{BENCH_COUNT} with --bench)")
+    parser.add_argument("--timeout", type=float, default=None,
+                        help="give up on a scenario when no SMS came for this "
+                        f"many seconds (default: never, {BENCH_TIMEOUT_S} with --bench)")
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    names = list(SCENARIOS) if args.bench else [args.scenario]
+    if args.bench and args.count == 0:
+        args.count = BENCH_COUNT
+    if args.timeout is None:
+        args.timeout = BENCH_TIMEOUT_S if args.bench else 0
+
+    lib = None if args.port else build_driver()
+    results = {name: run_scenario(name, args, lib) for name in names}
+
+    print("\n[SIM800] scenario     n  uplinks   mean(s)   min(s)   max(s)")
+    failed = []
+    for name, (times, uplinks) in results.items():
+        sent = f"{sum(1 for ok in uplinks if ok)}/{len(uplinks)}" if lib else "-"
+        if times:
+            print(f"[SIM800] {name:<10} {len(times):>3} {sent:>8}"
+                  f" {sum(times) / len(times):>9.3f} {min(times):>8.3f} {max(times):>8.3f}")
+        else:
+            print(f"[SIM800] {name:<10}   0 {sent:>8}         -        -        -")
+            failed.append(name)
+
+    if failed:
+        print(f"[SIM800] FAIL: no SMS in {', '.join(failed)}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,311 @@
+import argparse
+import bisect
+import ctypes
+import difflib
+import random
+import sys
+
+from host_build import build_firmware
+
+# ==============================
+# CONFIGURATION
+# ==============================
+UART_SOURCES = ["components/UART/UART.c", "components/UART/UART_tests.c",
+                "components/ring_buffer/ring_buffer.c"]
+
+# Receiver variants: SOFT_UART_FRAME_MODE_BAUD of each build
+VARIANTS = {
+    "table": None,          # as shipped, frame mode from 115200
+    "bit": 10000000,        # one FRC1 interrupt per bit at every rate
+    "frame": 1,             # whole frame per edge interrupt at every rate
+}
+
+RATES = [9600, 19200, 38400, 57600, 115200]     # s_timings in UART.c
+CPU_MHZ = [80, 160]
+FRAME_MODE_BAUD = 115200                        # SOFT_UART_FRAME_MODE_BAUD
+
+# Interrupt entry (us), SOFT_UART_EDGE_LATENCY_TICKS is what the firmware assumes
+EDGE_LATENCY_US = 2.0
+TIMER_LATENCY_US = 1.0
+LATENCY_JITTER_US = 0.5     # extra entry delay: critical sections, flash cache
+
+# Line impairments
+N_BYTES = 2000
+MISMATCH_PCT = 1.0          # sender rate above nominal
+EDGE_JITTER_PCT = 1.0       # sigma of each edge, % of a bit (crystal peer, cable)
+GLITCH_RATE = 0.01          # short inverted pulses per byte
+GLITCH_NS = 300
+IDLE_BITS_MAX = 4           # random idle between frames
+SWEEP_PCT = [-6, -5, -4, -3, -2, -1, 0, 1, 2, 3, 4, 5, 6]
+
+DRAIN_EVERY = 64            # bytes between ring drains, well below SOFT_UART_RX_RING_SIZE
+TX_EDGES_MAX = 65536        # SIM_TX_EDGES_MAX
+# ==============================
+
+
+class RxStats(ctypes.Structure):
+    _fields_ = [(name, ctypes.c_uint32) for name in
+                ("bytes", "frame_errors", "noise", "glitches", "overruns", "peak")]
+
+
+def build_uart(variant):
+    """Compiles UART.c against the chip model and loads it with ctypes."""
+    defines = {}
+    if VARIANTS[variant] is not None:
+        defines["SOFT_UART_FRAME_MODE_BAUD"] = VARIANTS[variant]
+    lib = build_firmware(f"soft_uart_{variant}", UART_SOURCES, defines)
+    lib.sim_reset.argtypes = [ctypes.c_uint32] * 5
+    lib.sim_load_rx.argtypes = [ctypes.POINTER(ctypes.c_uint64),
+                                ctypes.POINTER(ctypes.c_uint8), ctypes.c_size_t]
+    lib.sim_load_rx.restype = ctypes.c_bool
+    lib.sim_run.argtypes = [ctypes.c_uint64]
+    lib.sim_now.restype = ctypes.c_uint64
+    lib.sim_isr_cycles.restype = ctypes.c_uint64
+    lib.sim_tx_edges.argtypes = [ctypes.POINTER(ctypes.c_uint64),
+                                 ctypes.POINTER(ctypes.c_uint8), ctypes.c_size_t]
+    lib.sim_tx_edges.restype = ctypes.c_size_t
+    lib.soft_uart_set_baud.argtypes = [ctypes.c_uint32, ctypes.c_uint32]
+    lib.soft_uart_read_span.argtypes = [ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8))]
+    lib.soft_uart_read_span.restype = ctypes.c_size_t
+    lib.soft_uart_consume.argtypes = [ctypes.c_size_t]
+    lib.soft_uart_rx_get_stats.argtypes = [ctypes.POINTER(RxStats)]
+    lib.soft_uart_write.argtypes = [ctypes.c_char_p, ctypes.c_size_t]
+    lib.soft_uart_write.restype = ctypes.c_size_t
+    lib.soft_uart_tx_wait.argtypes = [ctypes.c_uint32]
+    lib.soft_uart_tx_wait.restype = ctypes.c_bool
+    lib.uart_bitbang_send_string.argtypes = [ctypes.c_char_p, ctypes.c_size_t]
+    lib.soft_uart_autobaud.argtypes = [ctypes.c_uint32]
+    lib.soft_uart_autobaud.restype = ctypes.c_uint32
+    if lib.soft_uart_rx_init() != 0 or lib.init_transmit() != 0:
+        raise RuntimeError("soft UART init failed on the host")
+    return lib
+
+
+def waveform(data, baud, mhz, args, rng):
+    """RX_PIN transitions (CPU cycle, level) of `data` sent by an imperfect peer.
+
+    Returns the transitions and the cycle at which each frame ends."""
+    bit = mhz * 1e6 / (baud * (1 + args.mismatch / 100.0))
+    sigma = bit * args.jitter / 100.0
+    glitch = args.glitch_ns * mhz / 1000.0
+    t = 20 * bit
+    edges, ends = [], []
+    for byte in data:
+        bits = [0] + [(byte >> i) & 1 for i in range(8)] + [1]
+        level = 1
+        for k, b in enumerate(bits):
+            if b != level:
+                # The start edge anchors the frame, data edges wander around it
+                edges.append((t + k * bit + (rng.gauss(0, sigma) if k else 0), b))
+                level = b
+        if rng.random() < args.glitch_rate:
+            at = rng.uniform(0, 10)
+            level = bits[int(at)]
+            edges.append((t + at * bit, 1 - level))
+            edges.append((t + at * bit + glitch, level))
+        t += 10 * bit
+        ends.append(int(t))
+        t += rng.randint(0, IDLE_BITS_MAX) * bit
+    edges.sort()
+    return [(int(round(when)), level) for when, level in edges], ends
+
+
+def load_rx(lib, edges):
+    times = (ctypes.c_uint64 * len(edges))(*[e[0] for e in edges])
+    levels = (ctypes.c_uint8 * len(edges))(*[e[1] for e in edges])
+    if not lib.sim_load_rx(times, levels, len(edges)):
+        raise RuntimeError("waveform does not fit")
+
+
+def drain(lib, out):
+    span = ctypes.POINTER(ctypes.c_uint8)()
+    while True:
+        n = lib.soft_uart_read_span(ctypes.byref(span))
+        if n == 0:
+            return
+        out += ctypes.string_at(span, n)
+        lib.soft_uart_consume(n)
+
+
+def reset(lib, mhz, args, seed):
+    lib.sim_reset(mhz, int(args.edge_latency * mhz), int(args.timer_latency * mhz),
+                  int(args.latency_jitter * mhz), seed)
+
+
+def run_rx(lib, baud, mhz, args, seed):
+    """Receives N random bytes; returns (byte error rate, cycles per byte, stats)."""
+    rng = random.Random(seed)
+    data = bytes(rng.randrange(256) for _ in range(args.bytes))
+    edges, ends = waveform(data, baud, mhz, args, rng)
+
+    reset(lib, mhz, args, seed)
+    lib.soft_uart_set_baud(baud, baud)
+    load_rx(lib, edges)
+    before = RxStats()
+    lib.soft_uart_rx_get_stats(ctypes.byref(before))
+
+    got = bytearray()
+    for i in range(DRAIN_EVERY - 1, len(ends) + DRAIN_EVERY - 1, DRAIN_EVERY):
+        lib.sim_run(ends[min(i, len(ends) - 1)])
+        drain(lib, got)
+    lib.sim_run(lib.sim_now() + int(20 * mhz * 1e6 / baud))
+    drain(lib, got)
+
+    after = RxStats()
+    lib.soft_uart_rx_get_stats(ctypes.byref(after))
+    delta = {name: getattr(after, name) - getattr(before, name)
+             for name, _ in RxStats._fields_ if name != "peak"}
+    matcher = difflib.SequenceMatcher(None, data, bytes(got), autojunk=False)
+    matched = sum(block.size for block in matcher.get_matching_blocks())
+    errors = len(data) - matched + max(0, len(got) - matched)
+    return errors / len(data), lib.sim_isr_cycles() / len(data), delta
+
+
+def decode_tx(edges, baud, mhz):
+    """Ideal receiver on the TX_PIN capture: bytes and worst edge error (% bit)."""
+    bit = mhz * 1e6 / baud
+    times = [when for when, _ in edges]
+
+    def level_at(t):
+        i = bisect.bisect_right(times, t)
+        return edges[i - 1][1] if i else 1
+
+    out, worst, i = bytearray(), 0.0, 0
+    while i < len(edges):
+        when, lv = edges[i]
+        if lv != 0:
+            i += 1
+            continue
+        start = when
+        byte = sum(level_at(start + (k + 1.5) * bit) << k for k in range(8))
+        out.append(byte)
+        end = start + 9.5 * bit
+        i += 1
+        while i < len(edges) and edges[i][0] < end:
+            pos = (edges[i][0] - start) / bit
+            worst = max(worst, abs(pos - round(pos)) * 100)
+            i += 1
+    return bytes(out), worst
+
+
+def run_tx(lib, baud, mhz, args, seed):
+    """Sends N random bytes; returns (byte error rate, cycles per byte, worst edge %)."""
+    rng = random.Random(seed)
+    data = bytes(rng.randrange(256) for _ in range(min(args.bytes, TX_EDGES_MAX // 10)))
+
+    reset(lib, mhz, args, seed)
+    lib.soft_uart_set_baud(baud, baud)
+    lib.uart_bitbang_send_string(data, len(data))
+    lib.soft_uart_tx_wait(0xFFFFFFFF)
+
+    times = (ctypes.c_uint64 * TX_EDGES_MAX)()
+    levels = (ctypes.c_uint8 * TX_EDGES_MAX)()
+    n = lib.sim_tx_edges(times, levels, TX_EDGES_MAX)
+    got, worst = decode_tx(list(zip(times[:n], levels[:n])), baud, mhz)
+    errors = sum(a != b for a, b in zip(data, got)) + abs(len(data) - len(got))
+    return errors / len(data), lib.sim_isr_cycles() / len(data), worst
+
+
+def mode(variant, baud):
+    if variant == "table":
+        return "frame" if baud >= FRAME_MODE_BAUD else "bit"
+    return variant
+
+
+def report(libs, args):
+    print(f"[SOFT_UART] {args.bytes} bytes, mismatch {args.mismatch:+.1f} %, "
+          f"edge jitter {args.jitter:.1f} %, glitches {args.glitch_rate:.3f}/byte "
+          f"of {args.glitch_ns} ns, entry jitter {args.latency_jitter:.1f} us")
+    for baud in args.baud or RATES:
+        for mhz in args.mhz or CPU_MHZ:
+            for variant, lib in libs.items():
+                ber, cycles, st = run_rx(lib, baud, mhz, args, args.seed)
+                print(f"[SOFT_UART] RX {baud:>6} {mhz:>3} MHz {variant:<5} "
+                      f"({mode(variant, baud):<5}) errors {100 * ber:6.2f} %, "
+                      f"{cycles:8.0f} cycles/byte, frame {st['frame_errors']}, "
+                      f"noise {st['noise']}, glitch {st['glitches']}, "
+                      f"overrun {st['overruns']}")
+            for variant, lib in libs.items():
+                ber, cycles, worst = run_tx(lib, baud, mhz, args, args.seed)
+                print(f"[SOFT_UART] TX {baud:>6} {mhz:>3} MHz {variant:<5} "
+                      f"({mode(variant, baud):<5}) errors {100 * ber:6.2f} %, "
+                      f"{cycles:8.0f} cycles/byte, worst edge {worst:4.1f} % of a bit")
+
+
+def sweep(libs, args):
+    mhz = (args.mhz or [160])[0]
+    print(f"[SOFT_UART] RX byte errors (%) against the sender rate mismatch, {mhz} MHz")
+    print("[SOFT_UART] " + " " * 20 + "".join(f"{p:>+7d}" for p in SWEEP_PCT))
+    for baud in args.baud or RATES:
+        for variant, lib in libs.items():
+            row = []
+            for pct in SWEEP_PCT:
+                args.mismatch = pct
+                ber, _, _ = run_rx(lib, baud, mhz, args, args.seed)
+                row.append(f"{100 * ber:7.1f}")
+            print(f"[SOFT_UART] {baud:>6} {variant:<5} ({mode(variant, baud):<5})"
+                  + "".join(row))
+
+
+def autobaud(lib, args):
+    """Runs soft_uart_autobaud() on NMEA text; a rate off the table must give 0."""
+    failed = 0
+    for mhz in args.mhz or CPU_MHZ:
+        for baud in args.baud or RATES:
+            rng = random.Random(args.seed)
+            text = b"$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n" * 4
+            edges, _ = waveform(text, baud, mhz, args, rng)
+            reset(lib, mhz, args, args.seed)
+            lib.soft_uart_set_baud(RATES[0], RATES[0])
+            load_rx(lib, edges)
+            sys.stdout.flush()
+            found = lib.soft_uart_autobaud(int(1000 * edges[-1][0] / (mhz * 1e6)) + 10)
+            lib.sim_run(lib.sim_now() + int(20 * mhz * 1e6 / RATES[0]))
+            expected = baud if baud in RATES else 0
+            failed += found != expected
+            print(f"[SOFT_UART] autobaud {baud:>6} {mhz:>3} MHz -> {found}"
+                  f"{'' if found == expected else '  MISMATCH'}")
+    return failed
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Bit-level host simulation of the soft UART under line impairments")
+    parser.add_argument("--baud", type=int, action="append",
+                        help="rate to simulate (repeatable, default: every table rate)")
+    parser.add_argument("--mhz", type=int, action="append", choices=CPU_MHZ,
+                        help="CPU clock (repeatable, default: both)")
+    parser.add_argument("--variant", action="append", choices=list(VARIANTS),
+                        help="receiver variant (repeatable, default: all)")
+    parser.add_argument("--bytes", type=int, default=N_BYTES)
+    parser.add_argument("--mismatch", type=float, default=MISMATCH_PCT,
+                        help="sender rate error in %%")
+    parser.add_argument("--jitter", type=float, default=EDGE_JITTER_PCT,
+                        help="edge jitter sigma in %% of a bit")
+    parser.add_argument("--glitch-rate", type=float, default=GLITCH_RATE)
+    parser.add_argument("--glitch-ns", type=int, default=GLITCH_NS)
+    parser.add_argument("--edge-latency", type=float, default=EDGE_LATENCY_US,
+                        help="edge to GPIO handler entry in us")
+    parser.add_argument("--timer-latency", type=float, default=TIMER_LATENCY_US,
+                        help="FRC1 expiry to handler entry in us")
+    parser.add_argument("--latency-jitter", type=float, default=LATENCY_JITTER_US,
+                        help="extra random handler entry delay in us")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--sweep", action="store_true",
+                        help="byte errors against the rate mismatch instead")
+    parser.add_argument("--autobaud", action="store_true",
+                        help="check soft_uart_autobaud() at every rate instead")
+    args = parser.parse_args()
+
+    libs = {v: build_uart(v) for v in args.variant or VARIANTS}
+    if args.autobaud:
+        return 1 if autobaud(libs.get("table") or next(iter(libs.values())), args) else 0
+    elif args.sweep:
+        sweep(libs, args)
+    else:
+        report(libs, args)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
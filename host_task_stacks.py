@@ -0,0 +1,149 @@
+import argparse
+import os
+import re
+import sys
+import time
+
+# ==============================
+# CONFIGURATION
+# ==============================
+REPO_DIR = os.path.dirname(os.path.abspath(__file__))
+HEADER = os.path.join(REPO_DIR, "components/task_registry/task_stacks.h")
+
+# Task names printed by task_registry_report() -> macro in task_stacks.h
+TASKS = {
+    "ota_task": "TASK_STACK_OTA",
+    "wake_cycle": "TASK_STACK_WAKE_CYCLE",
+    "gps_task": "TASK_STACK_GPS",
+    "sim800_task": "TASK_STACK_SIM800",
+    "battery": "TASK_STACK_BATTERY",
+    "uart_rx_task": "TASK_STACK_UART_RX",
+}
+
+MARGIN_NUM, MARGIN_DEN = 5, 4   # depth = peak * 5/4 ...
+ROUND = 256                     # ... rounded up to a multiple of this
+STACK_MIN = 768                 # TASK_STACK_MIN in task_registry.h
+# ==============================
+
+LINE_RE = re.compile(r"Task stack:\s+(\S+)\s+peak\s+(\d+)\s+of\s+(\d+)")
+DEFINE_RE = re.compile(r"#define\s+(TASK_STACK_\w+)\s+(\d+)\s*(//.*)?")
+
+TEMPLATE = """/**
+ * @file task_stacks.h
+ * @brief Stack depth of every registered task.
+ *
+ * Rewritten by host_task_stacks.py from the "Task stack:" lines printed by
+ * task_registry_report() during a profiling run:
+ *
+ *     python3 host_task_stacks.py monitor.log
+ *
+ * Depth = peak use * {num}/{den}, rounded up to {round}, at least TASK_STACK_MIN.
+ * Entries marked "not profiled yet" keep the task's stack size from before
+ * the registry, unchanged until a log covers the task.
+ *
+ * @version 0.1
+ * @date {date}
+ */
+
+#ifndef TASK_STACKS_H_
+#define TASK_STACKS_H_
+
+{defines}
+
+#endif /* TASK_STACKS_H_ */
+"""
+
+
+def read_logs(paths):
+    """Returns {task: (max peak, depth at that time, samples)} from monitor logs."""
+    peaks = {}
+    for path in paths:
+        with open(path, errors="replace") as f:
+            for line in f:
+                m = LINE_RE.search(line)
+                if not m:
+                    continue
+                name, peak, depth = m.group(1), int(m.group(2)), int(m.group(3))
+                old = peaks.get(name, (0, depth, 0))
+                peaks[name] = (max(old[0], peak), depth, old[2] + 1)
+    return peaks
+
+
+def capture(port, baud, seconds, out_path):
+    """Copies a serial monitor session to out_path for the given duration."""
+    import serial  # pyserial, only needed for a live capture
+    print(f"[STACKS] Capturing {port} for {seconds:.0f} s into {out_path}")
+    with serial.Serial(port, baud, timeout=0.5) as ser, open(out_path, "wb") as out:
+        end = time.monotonic() + seconds
+        while time.monotonic() < end:
+            out.write(ser.read(4096))
+
+
+def current_table():
+    table = {}
+    with open(HEADER) as f:
+        for line in f:
+            m = DEFINE_RE.match(line.strip())
+            if m:
+                table[m.group(1)] = (int(m.group(2)), (m.group(3) or "").lstrip("/ ").strip())
+    return table
+
+
+def sized(peak):
+    depth = -(-peak * MARGIN_NUM // MARGIN_DEN)
+    depth = -(-depth // ROUND) * ROUND
+    return max(depth, STACK_MIN)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Regenerate task_stacks.h from measured stack high-water marks")
+    parser.add_argument("logs", nargs="*", help="serial monitor logs of profiling runs")
+    parser.add_argument("--port", help="capture a live run from this serial port first")
+    parser.add_argument("--baud", type=int, default=74880)
+    parser.add_argument("--seconds", type=float, default=1800,
+                        help="duration of the live capture")
+    parser.add_argument("--dry-run", action="store_true", help="print, do not write")
+    args = parser.parse_args()
+
+    logs = list(args.logs)
+    if args.port:
+        path = "stack_profile.log"
+        capture(args.port, args.baud, args.seconds, path)
+        logs.append(path)
+    if not logs:
+        parser.error("give at least one log file or --port")
+
+    peaks = read_logs(logs)
+    table = current_table()
+    defines = []
+    saved = 0
+
+    print(f"[STACKS] {'task':<13} {'samples':>7} {'peak':>6} {'old':>6} {'new':>6}")
+    for name, macro in TASKS.items():
+        old, comment = table.get(macro, (STACK_MIN, ""))
+        if name in peaks:
+            peak, _, samples = peaks[name]
+            new = sized(peak)
+            comment = f"peak: {peak} ({samples} samples)"
+            print(f"[STACKS] {name:<13} {samples:>7} {peak:>6} {old:>6} {new:>6}")
+        else:
+            new = old
+            print(f"[STACKS] {name:<13} {0:>7} {'-':>6} {old:>6} {new:>6} (kept)")
+        saved += old - new
+        defines.append(f"#define {macro:<21} {new:>4} // {comment or 'peak: not profiled yet'}")
+
+    print(f"[STACKS] Stack units saved: {saved}")
+    text = TEMPLATE.format(num=MARGIN_NUM, den=MARGIN_DEN, round=ROUND,
+                           date=time.strftime("%Y-%m-%d"), defines="\n".join(defines))
+    if args.dry_run:
+        print(text)
+    else:
+        with open(HEADER, "w") as f:
+            f.write(text)
+        print(f"[STACKS] Wrote {HEADER}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -20,25 +20,47 @@
 #include "../components/sim800L_driver/sim800L_driver.h"
 #include "../components/NEO_6M_driver/NEO_6M.h"
 #include "../components/OTA/OTA.h"
+#include "../components/battery/battery.h"
+#include "../components/geofence/geofence.h"
+#include "../components/rtc_clock/rtc_clock.h"
+#include "../components/wake_cycle/wake_cycle.h"
+#include "../components/task_registry/task_registry.h"
+#include "../components/boot_timeline/boot_timeline.h"
+#include "../components/energy/energy.h"
+#include "../components/transport/transport.h"
+#include "../components/debugging/my_print.h"
+
+/** @brief UART0, shared by the GPS, the SIM800L and the console */
+static transport_t s_uart0;
 
 /**
- * @brief Initializes essential ESP peripherals including UART, OTA, GPIO, and ADC.
+ * @brief Powers the GPS receiver and parks the SIM800L off.
  *
- * This function performs the initial setup of core ESP microcontroller peripherals
- * required for the application. It configures UART communication, sets up OTA
- * interrupt handling, and initializes the ADC for analog readings.
+ * Runs first on every boot: the receiver needs about a second before it
+ * outputs anything (longer on a cold start), so the rest of the init
+ * overlaps with it instead of adding to the time to first fix.
+ */
+static void init_power(void) {
+	gpio_config_t io_conf_out = { .pin_bit_mask = (1ULL << GPS_gpio)
+			| (1ULL << SIM_gpio), .mode = GPIO_MODE_OUTPUT, .pull_up_en =
+			GPIO_PULLUP_DISABLE, .pull_down_en = GPIO_PULLDOWN_DISABLE,
+			.intr_type = GPIO_INTR_DISABLE };
+	gpio_config(&io_conf_out);
+
+	gpio_set_level(GPS_gpio, 1);
+	gpio_set_level(SIM_gpio, 1);
+	energy_set(ENERGY_GPS, true);
+}
+
+/**
+ * @brief Initializes the peripherals every wake cycle needs: UART and ADC.
  *
- * The initialization steps include:
  * 1. **UART Initialization:**  
  *    - Creates a `uart_t` structure with default parameters (UART0, baud rate 9600, etc.).  
- *    - Calls `my_uart_init()` to configure the UART peripheral.
- * 2. **OTA Semaphore:**  
- *    - Creates a binary semaphore `ota_sem` for OTA update handling.
- * 3. **OTA GPIO Interrupt Configuration:**  
- *    - Configures the `OTA_GPIO` pin as input with pull-up enabled.  
- *    - Sets interrupt type to negative edge (`GPIO_INTR_NEGEDGE`).  
- *    - Installs ISR service and attaches `ota_isr_handler` to the GPIO.
- * 4. **ADC Initialization:**  
+ *    - Calls `transport_uart_init()` to configure the UART peripheral, and
+ *      binds the GPS and SIM800 drivers to it. Moving a peripheral off the
+ *      console port is a matter of binding it to another transport here.
+ * 2. **ADC Initialization:**  
  *    - Configures ADC with `ADC_READ_TOUT_MODE` for reading A0 pin.  
  *    - Sets the sample clock divider (`clk_div`) to 8.  
  *    - Calls `adc_init()` and checks for successful initialization.
@@ -48,10 +70,31 @@
 void init_esp() {
 	// UART init
 	uart_t uart0 = { 0, 3, 1, 1, 1, 9600 };
-	my_uart_init(&uart0);
+	transport_uart_init(&s_uart0, &uart0);
+	gps_set_transport(&s_uart0);
+	sim800_set_transport(&s_uart0);
 
 	printf("Initialization done!\n");
 
+	// Initialize ADC
+	adc_config_t adc_cfg = { .mode = ADC_READ_TOUT_MODE,  // read A0 pin
+			.clk_div = 8                 // sample clock divider (8–32)
+			};
+	if (adc_init(&adc_cfg) != ESP_OK) {
+		printf("ADC initialization failed!\n");
+	} else {
+		printf("ADC initialized successfully.\n");
+	}
+}
+
+/**
+ * @brief Sets up the OTA trigger: semaphore, button interrupt and task.
+ *
+ * Only done on a power-on or external reset. A timer wake has nobody at
+ * the button, so it skips this and the OTA task's stack stays unused;
+ * resetting the board brings the trigger back.
+ */
+static void init_ota(void) {
 	// OTA semaphore
 	ota_sem = xSemaphoreCreateBinary();
 
@@ -63,63 +106,80 @@ void init_esp() {
 	gpio_install_isr_service(0);
 	gpio_isr_handler_add(OTA_GPIO, ota_isr_handler, NULL);
 
-	// Initialize ADC
-	adc_config_t adc_cfg = { .mode = ADC_READ_TOUT_MODE,  // read A0 pin
-			.clk_div = 8                 // sample clock divider (8–32)
-			};
-	if (adc_init(&adc_cfg) != ESP_OK) {
-		printf("ADC initialization failed!\n");
-	} else {
-		printf("ADC initialized successfully.\n");
-	}
+	task_registry_create(TASK_ID_OTA, ota_task, NULL);
 }
 
 /**
  * @brief Main application entry point for ESP8266.
  *
- * This function initializes the ESP peripherals, configures GPIOs for status
- * indicators, starts FreeRTOS tasks, and continuously monitors the battery voltage
- * using the ADC.
+ * Boots straight into a wake cycle, dispatching on the wake cause. Each
+ * step is marked on the boot timeline, printed at the end of the cycle.
  *
  * Initialization and setup steps:
- * 1. **ESP Peripheral Initialization:**  
- *    - Calls `init_esp()` to initialize UART, ADC, and OTA-related GPIO and semaphore.
- * 2. **GPIO Configuration for LEDs/Status Pins:**  
- *    - Configures `GPS_gpio` and `SIM_gpio` as output pins without pull-up/pull-down.  
- *    - Sets initial levels: GPS low (0), SIM high (1).
- * 3. **Task Creation:**  
- *    - Creates `ota_task` with priority 11 and `gps_task` with priority 10.
- * 4. **Battery Monitoring Loop:**  
- *    - Samples the ADC 100 times every 5 seconds.  
- *    - Computes the average ADC value and scales it using the measured ADC reference.  
- *    - Calculates battery voltage using the divider ratio (based on the resistor network).  
- *    - Prints ADC average, ADC voltage, and battery voltage to console.  
- *    - Warns if battery voltage falls below 3.4 V.
- *
- * @note The function runs an infinite loop and never returns.
+ * 0. **Logging and RTC Clock:**  
+ *    - `my_print_init()` initializes NVS (Wi-Fi needs it for OTA) and routes
+ *      ESP_LOG output through the per-task line slots into the RAM log
+ *      shown on `/logs`.
+ *    - Restores UTC across deep sleep (`rtc_clock_init()`), predicted from
+ *      the requested sleep when waking from a timed deep sleep.
+ *    - Restores the energy ledger (`energy_init()`) and charges the deep
+ *      sleep that just ended.
+ * 1. **Power:**  
+ *    - Switches the GPS on and the SIM800L off (`init_power()`), so the
+ *      receiver boots while the rest of the init runs.
+ * 2. **ESP Peripheral Initialization:**  
+ *    - Calls `init_esp()` to initialize UART and ADC.
+ * 3. **Geofences:**  
+ *    - Validates the flash-resident geofence table (`geofence_init()`)
+ *      before the first fix can reach the filter phase.
+ * 4. **Battery Monitor:**  
+ *    - Starts the background battery sampling task (`battery_monitor_start()`),
+ *      so the SIM task can read a filtered voltage without waiting on the ADC.
+ * 5. **OTA (cold boot only):**  
+ *    - On any reset other than a deep-sleep timer wake, `init_ota()` arms
+ *      the OTA button and creates `ota_task`.
+ * 6. **Wake Cycle:**  
+ *    - Starts the wake-cycle orchestrator (`wake_cycle_start()`), which
+ *      creates the GPS and SIM800 tasks with static stacks and runs the
+ *      cycle through to deep sleep.
  */
 
 void app_main(void) {
+	boot_timeline_mark("app_main");
+	bool timer_wake = esp_reset_reason() == ESP_RST_DEEPSLEEP;
+
+	// Before any ESP_LOG output, so the RAM log sees the whole boot
+	my_print_init();
+	boot_timeline_mark("log");
+
+	// Predict UTC from the stored sleep start before anything reads the clock
+	rtc_clock_init(timer_wake);
+	// Charge the deep sleep that just ended to the energy ledger
+	energy_init(timer_wake);
+
+	// GPS first, everything below overlaps with the receiver boot
+	init_power();
+	boot_timeline_mark("gps_power");
+
 	init_esp();
-	// Configure GPIO4 for blinking
-	gpio_config_t io_conf_out = { .pin_bit_mask = 1ULL << GPS_gpio, .mode =
-			GPIO_MODE_OUTPUT, .pull_up_en = GPIO_PULLUP_DISABLE, .pull_down_en =
-			GPIO_PULLDOWN_DISABLE, .intr_type = GPIO_INTR_DISABLE };
-	gpio_config(&io_conf_out);
+	boot_timeline_mark("uart_adc");
 
-	// Configure GPIO4 for blinking
-	gpio_config_t io_conf_out1 = { .pin_bit_mask = 1ULL << SIM_gpio, .mode =
-			GPIO_MODE_OUTPUT, .pull_up_en = GPIO_PULLUP_DISABLE, .pull_down_en =
-			GPIO_PULLDOWN_DISABLE, .intr_type = GPIO_INTR_DISABLE };
+	// Geofence table stays in flash, only its header is checked here
+	geofence_init();
+	boot_timeline_mark("geofence");
 
-	gpio_config(&io_conf_out1);
+	// Sample the battery in the background while the GPS acquires
+	battery_monitor_start();
+	boot_timeline_mark("battery");
 
-	gpio_set_level(GPS_gpio, 0);
-	gpio_set_level(SIM_gpio, 1);
+	if (!timer_wake) {
+		init_ota();
+		boot_timeline_mark("ota");
+	}
 
-	vTaskDelay(3000);
-	// Start OTA task
-	xTaskCreate(ota_task, "ota_task", 4096, NULL, 11, NULL);
-	xTaskCreate(gps_task, "sim800_task", 4096, NULL, 10, NULL);
+	printf("Boot: %s\n", timer_wake ? "timer wake, fast path" : "cold boot");
 
+	// Last and unmarked: the orchestrator preempts app_main and slows the
+	// CPU clock the timeline converts cycles with
+	wake_cycle_start();
 }